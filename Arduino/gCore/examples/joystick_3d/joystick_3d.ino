@@ -2,10 +2,12 @@
  * 3D mesh rendering demo on gCore using Arvind Singh's tgx 3D library,
  * an optional Sparkfun I2C Joystick and both ESP32 processors.
  * 
- *    1. tgx rendering code draws the "naruto" 3D mesh into a 160x240
- *       pixel dual ping-pong frame buffer.  Its task runs on CPU 0.
- *    2. A display task running on CPU 1 pixel-doubles the image to
- *       320x480 pixels and uses DMA to draw data to the LCD.
+ *    1. tgx rendering code draws the "naruto" 3D mesh into a dual
+ *       ping-pong frame buffer of at most 160x240 pixels.  Its task runs
+ *       on CPU 0.  The rendering resolution is adjusted after each frame
+ *       to hold a target frame time (dynamic resolution).
+ *    2. A display task running on CPU 1 scales the image up to 320x480
+ *       pixels and uses DMA to draw data to the LCD.
  *    3. The Sparkfun joystick pans around the model (horizontal)
  *       and/or zooms in/out from the model (vertical).  The joystick
  *       button toggles between Texture mapped, Gouraud or flat shading
@@ -13,6 +15,11 @@
  *    4. gCore is configured so that short presses of the power button
  *       turn gCore on and off.
  *       
+ * The two tasks exchange the framebuffers through a tgx FramePipeline: each
+ * task blocks until the other hands it a buffer so a frame is sent to the
+ * LCD as soon as it is rendered.  The time spent in each stage is printed
+ * on the serial port every second.
+ * 
  * The demo is limited by the 3D rendering process on CPU 1 but demonstrates
  * very fast LCD updates.
  * 
@@ -59,8 +66,6 @@
 // Don't require always using the tgx:: prefix
 using namespace tgx;
 
-#define SWAP_BYTES(d) (d = d << 8 | d >> 8)
-
 // gCore driver
 gCore gc = gCore();
 
@@ -78,22 +83,32 @@ bool joystick_present = false;
 uint16_t j_center_x;
 uint16_t j_center_y;
 
-// Horribly terrible semaphores
-bool fb_full = false;
-bool fb2_full = false;
-
 // size of the drawing framebuffer (half the LCD display for speed's state)
 #define SLX (320/2)
 #define SLY (480/2)
 
+// LCD size
+#define LCD_LX 320
+#define LCD_LY 480
+
+// Target rendering time for a frame (the rendering resolution is lowered when a frame
+// takes longer and raised again when there is time left)
+#define TARGET_FRAME_MS 40.0f
+
+// Smallest rendering resolution as a fraction of SLX x SLY
+#define MIN_RENDER_SCALE 0.5f
+
 // Framebuffers tgx draws into
 uint16_t * fb;
 uint16_t * fb2;
 
-// Small buffers for eSPI_TFT DMA transfers (SLY must be even multiple of NUM_DRAW_LINES)
-// These buffers are used to double the rendered image as it's drawn to the LCD
+// Hand-off of the framebuffers between the render and display tasks
+FramePipeline<RGB565, 2> pipeline;
+
+// Small buffers for eSPI_TFT DMA transfers (NUM_DRAW_LINES lines of the LCD each)
+// These buffers are used to scale the rendered image up as it's drawn to the LCD
 #define NUM_DRAW_LINES 80
-#define DRAW_BUF_LEN (2*NUM_DRAW_LINES*SLX)
+#define DRAW_BUF_LEN (NUM_DRAW_LINES*LCD_LX)
 uint16_t* rbuf1;
 uint16_t* rbuf2;
 
@@ -103,6 +118,12 @@ float* zbuf;
 // 3D mesh drawer (with zbuffer and perspective projection)
 Renderer3D<RGB565, SLX, SLY, true, false> renderer;
 
+// Rendering resolution controller
+DynamicResolution dynres(SLX, SLY, TARGET_FRAME_MS, MIN_RENDER_SCALE);
+
+// Conversion of the rendered images to the LCD format
+ImageUpscaler upscaler;
+
 // Tasks to run on different CPUs
 TaskHandle_t disp_task_handle;
 TaskHandle_t draw_task_handle;
@@ -171,8 +192,12 @@ void setup()
     }
 #endif
 
+    // Give the framebuffers and the zbuffer to the pipeline (both framebuffers are free)
+    RGB565* buffers[2] = { (RGB565*)fb, (RGB565*)fb2 };
+    pipeline.begin(buffers, SLX, SLY, zbuf, SLX * SLY);
+
     // Setup the 3D renderer
-    renderer.setZbuffer(zbuf, SLX * SLY); // set the z buffer for depth testing
+    renderer.setZbuffer(pipeline.zbuffer(), pipeline.zbufferLen()); // set the z buffer for depth testing
     renderer.setPerspective(45, ((float)SLX) / SLY, 0.1f, 1000.0f);  // set the perspective projection matrix.     
     renderer.setMaterial(RGBf(0.85f, 0.55f, 0.25f), 0.2f, 0.7f, 0.8f, 64); // bronze color with a lot of specular reflexion. 
     renderer.setOffset(0, 0);
@@ -185,8 +210,16 @@ void setup()
 
 void loop() 
 {  
-  // Main loop does nothing
+  // Main loop only reports the time spent in each stage of the pipeline
   delay(1000);
+  FramePipeline<RGB565, 2>::Stats st = pipeline.getStats();
+  pipeline.resetStats();
+  if (st.frames > 0) {
+    Serial.printf("%u fps - render %u ms (wait %u ms) - display %u ms (wait %u ms) - %dx%d\n", st.frames,
+                  (uint32_t)(st.render_us / st.frames / 1000), (uint32_t)(st.render_wait_us / st.frames / 1000),
+                  (uint32_t)(st.display_us / st.frames / 1000), (uint32_t)(st.display_wait_us / st.frames / 1000),
+                  dynres.size().x, dynres.size().y);
+  }
 }
 
 
@@ -230,51 +263,29 @@ void get_joystick_center_offsets()
 void disp_task(void * parameter)
 {
   while (1) {
-    // Draw any valid frame buffers
-    if (fb_full) {
-      render_to_lcd(fb);
-      fb_full = false;
-    }
-    if (fb2_full) {
-      render_to_lcd(fb2);
-      fb2_full = false;
-    }
-
-    // Allow FreeRTOS to schedule (and keep the watchdog timer from expiring)
-    vTaskDelay(pdMS_TO_TICKS(20));
+    // Wait (blocked, so FreeRTOS can schedule other tasks) for the next rendered frame, draw it
+    // and give the framebuffer back to the render task
+    const Image<RGB565>* im = pipeline.next();
+    render_to_lcd(*im);
+    pipeline.release(im);
   }
 }
 
 
-void render_to_lcd(uint16_t* p)
+void render_to_lcd(const Image<RGB565>& im)
 {
-  int n = 0;
-  int x;
-  uint16_t* fbP = p;
-  uint16_t* rP;
-  uint16_t pixel;
-  
-  while (fbP < (p + (SLX * SLY))) {
-    // Swap bytes and pixel-double image into rbuf1 (in parallel with previous DMA)
-    rP = rbuf1;
-    x = 0;
-    while (rP < (rbuf1 + DRAW_BUF_LEN)) {
-      pixel = SWAP_BYTES(*fbP);
-      *rP++ = pixel;
-      *rP++ = pixel;
-      fbP++;
-      if (++x == SLX) {
-        // Built up one line: now double it
-        memcpy(rP, rP - (2 * SLX), 4 * SLX);
-        rP += (2 * SLX);
-        x = 0;
-      }
-    }
+  int y;
+  int n;
 
-    // Load the buffer for an asynchronous DMA (control falls out of pushImageDMA before DMA is finished
-    // by copying rbuf1 to rbuf2 and using that for the DMA)
+  // Swap bytes and scale the image up to the LCD size (2x when rendered at full resolution)
+  upscaler.begin(im, LCD_LX, LCD_LY, true);
+  
+  // Fill rbuf1 in parallel with the previous DMA then load the buffer for an asynchronous DMA
+  // (control falls out of pushImageDMA before DMA is finished by copying rbuf1 to rbuf2 and
+  // using that for the DMA)
+  while ((n = upscaler.next(rbuf1, NUM_DRAW_LINES, y)) > 0) {
     tft.dmaWait();
-    tft.pushImageDMA(0, NUM_DRAW_LINES * n++, 2 * SLX, NUM_DRAW_LINES, rbuf1, rbuf2);
+    tft.pushImageDMA(0, y, LCD_LX, n, rbuf1, rbuf2);
   }
 }
 
@@ -286,17 +297,19 @@ void render_to_lcd(uint16_t* p)
 
 void draw_task(void * parameter)
 {
-  bool pp = true;   // ping-pong control
   bool btn;
   fMat4 M;
   int cur_shader = 2;
   int shader = TGX_SHADER_GOURAUD | TGX_SHADER_TEXTURE;
-  
-  // Set the images that encapsulate the frame buffers
-  Image<RGB565> imfb(fb,SLX,SLY);
-  Image<RGB565> imfb2(fb2,SLX,SLY);
+  iVec2 size;
+  uint32_t t0;
+  Image<RGB565>* im;
     
   while (1) {
+    // Rendering resolution for this frame
+    size = dynres.size();
+    renderer.setViewportSize(size);
+
     // Compute the model position
     moveModel(&M, &btn);
     renderer.setModelMatrix(M);
@@ -310,27 +323,19 @@ void draw_task(void * parameter)
       }
     }
 
-    // Draw the 3D mesh into one of the ping-pong frame buffers
-    if (pp) {
-      while (fb_full) {};
-      renderer.setImage(&imfb);           // set the image to draw onto (ie the screen framebuffer)
-      imfb.fillScreen(RGB565_Black);             // clear the framebuffer (black background)
-    } else {
-      while (fb2_full) {};
-      renderer.setImage(&imfb2);
-      imfb2.fillScreen(RGB565_Black);
-    }
+    // Wait for a free framebuffer (image of the size being rendered) and draw the 3D mesh into it
+    im = pipeline.acquire(size);
+    t0 = micros();
+    renderer.setImage(im);                       // set the image to draw onto (ie the screen framebuffer)
+    im->fillScreen(RGB565_Black);                // clear the framebuffer (black background)
     renderer.clearZbuffer();                     // clear the z-buffer
     renderer.drawMesh(shader, &naruto_1, false); // draw the mesh !
 
-    // Signal display task and flip ping-pong buffer
-    if (pp) {
-      fb_full = true;
-      pp = false;
-    } else {
-      fb2_full = true;
-      pp = true;
-    }
+    // Choose the resolution of the next frame from the time spent on this one
+    dynres.update((micros() - t0) / 1000.0f);
+
+    // Hand the frame to the display task (which starts drawing it right away)
+    pipeline.submit(im);
 
     // Check for button press for soft power off (done in the same task that accesses the joystick since
     // both use I2C and we don't want different tasks trying to access it at the same time)
@@ -338,8 +343,8 @@ void draw_task(void * parameter)
       gc.power_off();
     }
 
-    // Allow FreeRTOS to schedule (and keep the watchdog timer from expiring)
-    vTaskDelay(pdMS_TO_TICKS(20));
+    // No delay needed here: the task blocks in pipeline.acquire() when the display task is
+    // behind, which lets FreeRTOS schedule other tasks
   }
 }
 
@@ -5056,7 +5056,22 @@ const tgx::Mesh3D<tgx::RGB565> naruto_3 =
     0.07790246218370915, 0.1210752484164588
     },
     
-    "naruto" // model name    
+    "naruto", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -5093,7 +5108,22 @@ const tgx::Mesh3D<tgx::RGB565> naruto_2 =
     0.008390761502363614, 0.15907298388304478
     },
     
-    "naruto" // model name    
+    "naruto", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -5130,7 +5160,22 @@ const tgx::Mesh3D<tgx::RGB565> naruto_1 =
     -0.195223555275581, 0.195223555275581
     },
     
-    "naruto" // model name    
+    "naruto", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
                 
@@ -81,6 +81,36 @@ void setup()
     renderer.setPerspective(45, ((float)SLX) / SLY, 0.1f, 1000.0f);  // set the perspective projection matrix.     
     renderer.setMaterial(RGBf(0.85f, 0.55f, 0.25f), 0.2f, 0.7f, 0.8f, 64); // bronze color with a lot of specular reflexion. 
     renderer.setOffset(0, 0);
+
+    // compare the float and fixed point lighting paths
+    benchmarkLighting(false);
+    benchmarkLighting(true);
+    renderer.useFixedPointLighting(false); // back to the default (float) lighting
+    }
+
+
+
+/** Print the number of triangles per second drawn with Gouraud shading using float or fixed point lighting */
+void benchmarkLighting(bool fixed_lighting)
+    {
+    const int NB = 50;
+    int nb_faces = 0; // the whole chain naruto_1 -> naruto_2 -> naruto_3 is drawn
+    for (const Mesh3D<RGB565>* m = &naruto_1; m != nullptr; m = m->next) nb_faces += m->nb_faces;
+    renderer.useFixedPointLighting(fixed_lighting);
+    uint32_t t = micros();
+    for (int k = 0; k < NB; k++)
+        {
+        fMat4 M;
+        M.setScale({ 9, 9, 9 });
+        M.multRotate(k * 7.0f, { 0,1,0 });
+        M.multTranslate({ 0, 0, -25 });
+        renderer.setModelMatrix(M);
+        imfb.fillScreen(RGB565_Black);
+        renderer.clearZbuffer();
+        renderer.drawMesh(TGX_SHADER_GOURAUD, &naruto_1, false);
+        }
+    t = micros() - t;
+    Serial.printf("%s lighting: %d triangles/s\n", (fixed_lighting ? "fixed point" : "float"), (int)((NB * (float)nb_faces * 1000000.0f) / t));
     }
 
 
@@ -9764,7 +9764,22 @@ const tgx::Mesh3D<tgx::RGB565> cyborg =
     -0.23075535744826633, 0.23075535744826633
     },
     
-    "cyborg"
+    "cyborg",
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
                 
@@ -25039,7 +25039,22 @@ const tgx::Mesh3D<tgx::RGB565> buddha =
     -0.3997194496505069, 0.3997194496505069
     },
     
-    "buddha" // model name    
+    "buddha", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
                 
@@ -23173,7 +23173,22 @@ const tgx::Mesh3D<tgx::RGB565> R2D2 =
     -0.4650256606529809, 0.4650256606529809
     },
     
-    "R2D2" // model name    
+    "R2D2", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
                 
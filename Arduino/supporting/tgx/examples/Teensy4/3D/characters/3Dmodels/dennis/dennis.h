@@ -15218,7 +15218,22 @@ const tgx::Mesh3D<tgx::RGB565> dennis =
     -0.2433156622798864, 0.2433156622798864
     },
     
-    "dennis" // model name    
+    "dennis", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
                 
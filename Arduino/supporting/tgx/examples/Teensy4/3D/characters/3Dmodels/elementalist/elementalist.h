@@ -18944,7 +18944,22 @@ const tgx::Mesh3D<tgx::RGB565> elementalist_7 =
     0.02161907261211315, 0.3199721987616645
     },
 
-    "elementalist"    
+    "elementalist",
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -18981,7 +18996,22 @@ const tgx::Mesh3D<tgx::RGB565> elementalist_6 =
     -0.3199721987616645, 0.1916991644730886
     },
 
-    "elementalist"    
+    "elementalist",
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -19018,7 +19048,22 @@ const tgx::Mesh3D<tgx::RGB565> elementalist_5 =
     -0.06286918864160121, 0.16142148442110738
     },
 
-    "elementalist"    
+    "elementalist",
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -19055,7 +19100,22 @@ const tgx::Mesh3D<tgx::RGB565> elementalist_4 =
     -0.10615798575100582, 0.19640681027201895
     },
 
-    "elementalist"  
+    "elementalist",
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -19092,7 +19152,22 @@ const tgx::Mesh3D<tgx::RGB565> elementalist_3 =
     -0.13178738126315714, 0.1775445982973174
     },
 
-    "elementalist"    
+    "elementalist",
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -19129,7 +19204,22 @@ const tgx::Mesh3D<tgx::RGB565> elementalist_2 =
     -0.035130520281954486, 0.15356081606833646
     },
 
-    "elementalist"    
+    "elementalist",
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -19166,7 +19256,22 @@ const tgx::Mesh3D<tgx::RGB565> elementalist_1 =
     -0.08171168992795284, 0.1526399143731027
     },
     
-    "elementalist"
+    "elementalist",
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
                 
@@ -39205,7 +39205,22 @@ const tgx::Mesh3D<tgx::RGB565> manga3_4  =
     -0.44403845697568856, 0.07555220112548244
     },
     
-    "manga3" // model name    
+    "manga3", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -39243,7 +39258,22 @@ const tgx::Mesh3D<tgx::RGB565> manga3_3  =
     0.11484061153288282, 0.1682972946533991
     },
     
-    "manga3" // model name    
+    "manga3", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -39281,7 +39311,22 @@ const tgx::Mesh3D<tgx::RGB565> manga3_2  =
     -0.18045771367994035, 0.3688488567642489
     },
     
-    "manga3" // model name    
+    "manga3", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -39318,7 +39363,22 @@ const tgx::Mesh3D<tgx::RGB565> manga3_1  =
     -0.3458052672168342, 0.44403845697568856
     },
     
-    "manga3" // model name    
+    "manga3", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
                 
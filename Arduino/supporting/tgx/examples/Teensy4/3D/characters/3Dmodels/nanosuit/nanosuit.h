@@ -19171,7 +19171,22 @@ const tgx::Mesh3D<tgx::RGB565> nanosuit_7 =
     -0.2131597410827449, 0.14424877999361976
     },
     
-    "nanosuit" // model name    
+    "nanosuit", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -19208,7 +19223,22 @@ const tgx::Mesh3D<tgx::RGB565> nanosuit_6 =
     -0.20081687618012986, 0.17553299837045086
     },
     
-    "nanosuit" // model name    
+    "nanosuit", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -19245,7 +19275,22 @@ const tgx::Mesh3D<tgx::RGB565> nanosuit_5 =
     -0.24833138261641796, 0.17269260365743255
     },
     
-    "nanosuit" // model name    
+    "nanosuit", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -19282,7 +19327,22 @@ const tgx::Mesh3D<tgx::RGB565> nanosuit_4 =
     0.04742208987524034, 0.06175177612236276
     },
     
-    "nanosuit" // model name    
+    "nanosuit", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -19319,7 +19379,22 @@ const tgx::Mesh3D<tgx::RGB565> nanosuit_3 =
     0.028202678409766955, 0.09679031625324402
     },
     
-    "nanosuit" // model name    
+    "nanosuit", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -19356,7 +19431,22 @@ const tgx::Mesh3D<tgx::RGB565> nanosuit_2 =
     -0.1649387733547158, 0.10337694963917127
     },
     
-    "nanosuit" // model name    
+    "nanosuit", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -19393,7 +19483,22 @@ const tgx::Mesh3D<tgx::RGB565> nanosuit_1 =
     0.04684549675383461, 0.24833138261641796
     },
     
-    "nanosuit" // model name    
+    "nanosuit", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
                 
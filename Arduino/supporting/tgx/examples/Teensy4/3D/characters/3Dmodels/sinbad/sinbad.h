@@ -17563,7 +17563,22 @@ const tgx::Mesh3D<tgx::RGB565> sinbad_7 =
     -0.4190432519475148, -0.05589628727915092
     },
 
-    "sinbad"    
+    "sinbad",
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -17600,7 +17615,22 @@ const tgx::Mesh3D<tgx::RGB565> sinbad_6 =
     -0.08298786169122412, 0.3394074433707943
     },
 
-    "sinbad"    
+    "sinbad",
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -17637,7 +17667,22 @@ const tgx::Mesh3D<tgx::RGB565> sinbad_5 =
     -0.1537991377613615, 0.4190432519475148
     },
 
-    "sinbad"    
+    "sinbad",
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -17674,7 +17719,22 @@ const tgx::Mesh3D<tgx::RGB565> sinbad_4 =
     -0.08427840158557116, 0.29722103446890935
     },
 
-    "sinbad"    
+    "sinbad",
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -17711,7 +17771,22 @@ const tgx::Mesh3D<tgx::RGB565> sinbad_3 =
     0.19579249822650618, 0.2966330133684933
     },
 
-    "sinbad"    
+    "sinbad",
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -17748,7 +17823,22 @@ const tgx::Mesh3D<tgx::RGB565> sinbad_2 =
     0.1948521082553503, 0.3370327257041331
     },
 
-    "sinbad"    
+    "sinbad",
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
 
@@ -17785,7 +17875,22 @@ const tgx::Mesh3D<tgx::RGB565> sinbad_1 =
     -0.14101755609111088, 0.4072133768809186
     },
 
-    "sinbad"    
+    "sinbad",
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
                 
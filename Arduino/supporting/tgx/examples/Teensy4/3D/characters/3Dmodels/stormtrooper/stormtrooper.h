@@ -13012,7 +13012,22 @@ const tgx::Mesh3D<tgx::RGB565> stormtrooper =
     -0.2133101767732101, 0.2133101767732101
     },
     
-    "stormtrooper" // model name    
+    "stormtrooper", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
                 
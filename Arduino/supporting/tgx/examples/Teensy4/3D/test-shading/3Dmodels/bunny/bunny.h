@@ -6266,7 +6266,22 @@ const tgx::Mesh3D<tgx::RGB565> bunny =
     -0.7759365864222039, 0.7759365864222039
     },
     
-    "Stanford bunny" // model name    
+    "Stanford bunny", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
                 
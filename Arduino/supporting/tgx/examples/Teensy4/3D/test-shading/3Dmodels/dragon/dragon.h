@@ -27444,7 +27444,22 @@ const tgx::Mesh3D<tgx::RGB565> dragon =
     -1.0, 1.0
     },
     
-    "Stanford dragon" // model name    
+    "Stanford dragon", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
                 
@@ -31039,7 +31039,22 @@ const tgx::Mesh3D<tgx::RGB565> suzanne =
     -0.603744390103135, 0.603744390103135
     },
     
-    "Suzanne (blender's monkey)" // model name    
+    "Suzanne (blender's monkey)", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
                 
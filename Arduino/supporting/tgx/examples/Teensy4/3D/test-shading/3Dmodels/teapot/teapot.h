@@ -2745,7 +2745,22 @@ const tgx::Mesh3D<tgx::RGB565> teapot =
     -0.62211977983181, 0.62211977983181
     },
     
-    "Utah teapot" // model name    
+    "Utah teapot", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
                 
@@ -18208,7 +18208,22 @@ const tgx::Mesh3D<tgx::RGB565> bob =
     -0.788369683460517f, 0.788369683460517f
     },
     
-    "bob" // model name    
+    "bob", // model name    
+
+    nullptr, // quantized array of vertices (compact format)
+    nullptr, // quantized array of texture coords (compact format)
+    nullptr, // octahedral array of normal vectors (compact format)
+
+    { // range of the quantized vertices
+    0.0f, 0.0f, 
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    },
+
+    { // range of the quantized texture coords
+    0.0f, 0.0f, 
+    0.0f, 0.0f
+    }
     };
     
                 
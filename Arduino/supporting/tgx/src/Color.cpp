@@ -296,6 +296,312 @@ HSV& HSV::operator=(const RGBf & c)
 
 
 
+/**********************************************************************
+* conversion of arrays of colors
+*
+* On MCU, the kernels read/write whole 32-bit words (4 RGB24 = 3 words,
+* 2 RGB565 = 1 word) when the buffers are aligned and fall back to per
+* pixel code for the remaining ones. On CPU, the simple loops are left to
+* the compiler which vectorizes them. Channels are extracted according to
+* the TGX_XXX_ORDER_BGR settings so the result is always the same as with
+* the per pixel constructors.
+***********************************************************************/
+
+
+#ifdef TGX_ON_ARDUINO
+#define TGX_COLOR_WORD_KERNELS 1
+#else
+#define TGX_COLOR_WORD_KERNELS 0
+#endif
+
+
+/** load/store a 32-bit word (compiles to a single load/store) */
+static inline TGX_INLINE uint32_t _loadWord(const void* p) { uint32_t w; memcpy(&w, p, 4); return w; }
+static inline TGX_INLINE void _storeWord(void* p, uint32_t w) { memcpy(p, &w, 4); }
+
+
+/** true if the pointer is 4-byte aligned */
+static inline TGX_INLINE bool _aligned4(const void* p) { return ((((uintptr_t)p) & 3) == 0); }
+
+
+/** raw RGB565 value from 8-bit channels (same as RGB565(RGB24(r,g,b))) */
+static inline TGX_INLINE uint16_t _to565(uint32_t r, uint32_t g, uint32_t b)
+    {
+    #if TGX_RGB565_ORDER_BGR
+    return (uint16_t)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+    #else
+    return (uint16_t)(((b >> 3) << 11) | ((g >> 2) << 5) | (r >> 3));
+    #endif
+    }
+
+
+/** 8-bit channels of the RGB565 value v (same as RGB24(RGB565)) */
+static inline TGX_INLINE void _from565(uint32_t v, uint32_t & r, uint32_t & g, uint32_t & b)
+    {
+    #if TGX_RGB565_ORDER_BGR
+    r = v >> 11; b = v & 31;
+    #else
+    b = v >> 11; r = v & 31;
+    #endif
+    g = (v >> 5) & 63;
+    r = (r << 3) | (r >> 2);
+    g = (g << 2) | (g >> 4);
+    b = (b << 3) | (b >> 2);
+    }
+
+
+/** shift of the R and B channels inside an RGB32 word (the G channel is always at bit 8 and A at bit 24) */
+#if TGX_RGB32_ORDER_BGR
+#define TGX_RGB32_SHIFT_R 16
+#define TGX_RGB32_SHIFT_B 0
+#else
+#define TGX_RGB32_SHIFT_R 0
+#define TGX_RGB32_SHIFT_B 16
+#endif
+
+
+/** shift of the R and B channels inside a 3 bytes RGB24 value (G is always the middle byte) */
+#if TGX_RGB24_ORDER_BGR
+#define TGX_RGB24_SHIFT_R 16
+#define TGX_RGB24_SHIFT_B 0
+#else
+#define TGX_RGB24_SHIFT_R 0
+#define TGX_RGB24_SHIFT_B 16
+#endif
+
+
+/** RGB565 value of a RGB24 color stored in the low 24 bits of a word */
+static inline TGX_INLINE uint16_t _rgb24word_to565(uint32_t w)
+    {
+    return _to565((w >> TGX_RGB24_SHIFT_R) & 255, (w >> 8) & 255, (w >> TGX_RGB24_SHIFT_B) & 255);
+    }
+
+
+/** RGB565 value of a RGB32 word */
+static inline TGX_INLINE uint16_t _rgb32word_to565(uint32_t w)
+    {
+    return _to565((w >> TGX_RGB32_SHIFT_R) & 255, (w >> 8) & 255, (w >> TGX_RGB32_SHIFT_B) & 255);
+    }
+
+
+/** store a pair of RGB565 values in a single word (first pixel in the low half) */
+static inline TGX_INLINE void _store565pair(RGB565* dst, uint16_t a, uint16_t b)
+    {
+    _storeWord(dst, ((uint32_t)a) | (((uint32_t)b) << 16));
+    }
+
+
+void convertColors(const RGB24* src, RGB565* dst, size_t n)
+    {
+    const uint8_t* s = (const uint8_t*)src;
+    if ((TGX_COLOR_WORD_KERNELS) && (n >= 4) && (!_aligned4(dst)))
+        { // align the destination on a word
+        dst->val = _rgb24word_to565(((uint32_t)s[0]) | (((uint32_t)s[1]) << 8) | (((uint32_t)s[2]) << 16));
+        s += 3; dst++; n--;
+        }
+    if ((TGX_COLOR_WORD_KERNELS) && (_aligned4(dst)))
+        { // 4 pixels = 3 source words -> 2 destination words
+        while (n >= 4)
+            {
+            const uint32_t w0 = _loadWord(s);
+            const uint32_t w1 = _loadWord(s + 4);
+            const uint32_t w2 = _loadWord(s + 8);
+            _store565pair(dst, _rgb24word_to565(w0), _rgb24word_to565((w0 >> 24) | (w1 << 8)));
+            _store565pair(dst + 2, _rgb24word_to565((w1 >> 16) | (w2 << 16)), _rgb24word_to565(w2 >> 8));
+            s += 12; dst += 4; n -= 4;
+            }
+        }
+    for (size_t i = 0; i < n; i++)
+        {
+        const uint8_t* p = s + 3 * i;
+        dst[i].val = _rgb24word_to565(((uint32_t)p[0]) | (((uint32_t)p[1]) << 8) | (((uint32_t)p[2]) << 16));
+        }
+    }
+
+
+void convertColors(const RGB32* src, RGB565* dst, size_t n)
+    {
+    if ((TGX_COLOR_WORD_KERNELS) && (n >= 2) && (!_aligned4(dst)))
+        {
+        dst->val = _rgb32word_to565(src->val);
+        src++; dst++; n--;
+        }
+    if ((TGX_COLOR_WORD_KERNELS) && (_aligned4(dst)))
+        {
+        while (n >= 2)
+            {
+            _store565pair(dst, _rgb32word_to565(src[0].val), _rgb32word_to565(src[1].val));
+            src += 2; dst += 2; n -= 2;
+            }
+        }
+    for (size_t i = 0; i < n; i++)
+        {
+        dst[i].val = _rgb32word_to565(src[i].val);
+        }
+    }
+
+
+void convertColors(const RGB565* src, RGB32* dst, size_t n)
+    {
+    const uint32_t A = ((uint32_t)RGB32::DEFAULT_A) << 24;
+    for (size_t i = 0; i < n; i++)
+        {
+        uint32_t r, g, b;
+        _from565(src[i].val, r, g, b);
+        dst[i].val = (r << TGX_RGB32_SHIFT_R) | (g << 8) | (b << TGX_RGB32_SHIFT_B) | A;
+        }
+    }
+
+
+void convertColors(const RGB565* src, RGB24* dst, size_t n)
+    {
+    uint8_t* d = (uint8_t*)dst;
+    if ((TGX_COLOR_WORD_KERNELS) && (_aligned4(d)))
+        { // 4 pixels -> 3 destination words
+        while (n >= 4)
+            {
+            uint32_t c[4];
+            for (int k = 0; k < 4; k++)
+                {
+                uint32_t r, g, b;
+                _from565(src[k].val, r, g, b);
+                c[k] = (r << TGX_RGB24_SHIFT_R) | (g << 8) | (b << TGX_RGB24_SHIFT_B);
+                }
+            _storeWord(d, c[0] | (c[1] << 24));
+            _storeWord(d + 4, (c[1] >> 8) | (c[2] << 16));
+            _storeWord(d + 8, (c[2] >> 16) | (c[3] << 8));
+            src += 4; d += 12; n -= 4;
+            }
+        }
+    for (size_t i = 0; i < n; i++)
+        {
+        uint32_t r, g, b;
+        _from565(src[i].val, r, g, b);
+        const uint32_t c = (r << TGX_RGB24_SHIFT_R) | (g << 8) | (b << TGX_RGB24_SHIFT_B);
+        uint8_t* p = d + 3 * i;
+        p[0] = (uint8_t)c; p[1] = (uint8_t)(c >> 8); p[2] = (uint8_t)(c >> 16);
+        }
+    }
+
+
+/** 4x4 Bayer matrix (values 0..15) */
+static const uint8_t _bayer4[4][4] = { { 0, 8, 2, 10 }, { 12, 4, 14, 6 }, { 3, 11, 1, 9 }, { 15, 7, 13, 5 } };
+
+
+/** RGB565 value of 8-bit channels with a dithering offset d in 0..15 */
+static inline TGX_INLINE uint16_t _to565dither(uint32_t r, uint32_t g, uint32_t b, uint32_t d)
+    {
+    r += (d >> 1); if (r > 255) r = 255;
+    g += (d >> 2); if (g > 255) g = 255;
+    b += (d >> 1); if (b > 255) b = 255;
+    return _to565(r, g, b);
+    }
+
+
+void convertColorsDithered(const RGB24* src, RGB565* dst, size_t n, int x, int y)
+    {
+    const uint8_t* row = _bayer4[y & 3];
+    for (size_t i = 0; i < n; i++)
+        {
+        const RGB24 c = src[i];
+        dst[i].val = _to565dither(c.R, c.G, c.B, row[(x + i) & 3]);
+        }
+    }
+
+
+void convertColorsDithered(const RGB32* src, RGB565* dst, size_t n, int x, int y)
+    {
+    const uint8_t* row = _bayer4[y & 3];
+    for (size_t i = 0; i < n; i++)
+        {
+        const uint32_t w = src[i].val;
+        dst[i].val = _to565dither((w >> TGX_RGB32_SHIFT_R) & 255, (w >> 8) & 255, (w >> TGX_RGB32_SHIFT_B) & 255, row[(x + i) & 3]);
+        }
+    }
+
+
+void swapColorBytes(const RGB565* src, uint16_t* dst, size_t n)
+    {
+    const uint16_t* s = (const uint16_t*)src;
+    if ((TGX_COLOR_WORD_KERNELS) && (n >= 2) && (!_aligned4(dst)))
+        {
+        const uint16_t v = *s;
+        *dst = (uint16_t)((v >> 8) | (v << 8));
+        s++; dst++; n--;
+        }
+    if ((TGX_COLOR_WORD_KERNELS) && (_aligned4(dst)))
+        { // two pixels per word
+        while (n >= 2)
+            {
+            const uint32_t w = _loadWord(s);
+            _storeWord(dst, ((w & 0x00FF00FF) << 8) | ((w >> 8) & 0x00FF00FF));
+            s += 2; dst += 2; n -= 2;
+            }
+        }
+    for (size_t i = 0; i < n; i++)
+        {
+        const uint16_t v = s[i];
+        dst[i] = (uint16_t)((v >> 8) | (v << 8));
+        }
+    }
+
+
+/** luma of 8-bit channels */
+static inline TGX_INLINE uint8_t _gray(uint32_t r, uint32_t g, uint32_t b)
+    {
+    return (uint8_t)((77 * r + 150 * g + 29 * b) >> 8);
+    }
+
+
+void convertToGray(const RGB565* src, uint8_t* dst, size_t n)
+    {
+    for (size_t i = 0; i < n; i++)
+        {
+        uint32_t r, g, b;
+        _from565(src[i].val, r, g, b);
+        dst[i] = _gray(r, g, b);
+        }
+    }
+
+
+void convertToGray(const RGB24* src, uint8_t* dst, size_t n)
+    {
+    for (size_t i = 0; i < n; i++)
+        {
+        const RGB24 c = src[i];
+        dst[i] = _gray(c.R, c.G, c.B);
+        }
+    }
+
+
+void convertToGray(const RGB32* src, uint8_t* dst, size_t n)
+    {
+    for (size_t i = 0; i < n; i++)
+        {
+        const uint32_t w = src[i].val;
+        dst[i] = _gray((w >> TGX_RGB32_SHIFT_R) & 255, (w >> 8) & 255, (w >> TGX_RGB32_SHIFT_B) & 255);
+        }
+    }
+
+
+void convertFromGray(const uint8_t* src, RGB565* dst, size_t n)
+    {
+    for (size_t i = 0; i < n; i++)
+        {
+        const uint32_t v = src[i];
+        dst[i].val = _to565(v, v, v);
+        }
+    }
+
+
+#undef TGX_RGB32_SHIFT_R
+#undef TGX_RGB32_SHIFT_B
+#undef TGX_RGB24_SHIFT_R
+#undef TGX_RGB24_SHIFT_B
+#undef TGX_COLOR_WORD_KERNELS
+
+
+
 }
 
 /* end of file */
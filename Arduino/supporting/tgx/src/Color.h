@@ -25,6 +25,7 @@
 
 #include <stdint.h>
 #include <math.h>
+#include <string.h>
 #include <type_traits>
 
 #include "Vec3.h"
@@ -3777,6 +3778,77 @@ inline RGBf& RGBf::operator=(fVec4 v)
 
 
 
+/**********************************************************************
+* conversion of arrays of colors
+***********************************************************************/
+
+
+/**
+* Convert n colors from src to dst (generic version: one constructor call per pixel).
+* 
+* The overloads below use faster word based kernels for the most common conversions. 
+* They give exactly the same result as the per pixel constructors. 
+**/
+template<typename color_src, typename color_dst> inline void convertColors(const color_src* src, color_dst* dst, size_t n)
+    {
+    for (size_t i = 0; i < n; i++) { dst[i] = color_dst(src[i]); }
+    }
+
+
+/**
+* Same color type: plain copy (src and dst may overlap).
+**/
+template<typename color_t> inline void convertColors(const color_t* src, color_t* dst, size_t n)
+    {
+    memmove(dst, src, n * sizeof(color_t));
+    }
+
+
+/** RGB24 to RGB565 */
+void convertColors(const RGB24* src, RGB565* dst, size_t n);
+
+/** RGB32 to RGB565 */
+void convertColors(const RGB32* src, RGB565* dst, size_t n);
+
+/** RGB565 to RGB32 */
+void convertColors(const RGB565* src, RGB32* dst, size_t n);
+
+/** RGB565 to RGB24 */
+void convertColors(const RGB565* src, RGB24* dst, size_t n);
+
+
+/**
+* RGB24 to RGB565 with 4x4 ordered dithering. (x, y) is the position of the first pixel 
+* in the image so that successive calls (one per line for instance) follow the same pattern.
+**/
+void convertColorsDithered(const RGB24* src, RGB565* dst, size_t n, int x, int y);
+
+/** RGB32 to RGB565 with 4x4 ordered dithering (see above). */
+void convertColorsDithered(const RGB32* src, RGB565* dst, size_t n, int x, int y);
+
+
+/**
+* Swap the two bytes of n RGB565 colors (for SPI displays expecting big endian pixels).
+* src and dst may be the same buffer.
+**/
+void swapColorBytes(const RGB565* src, uint16_t* dst, size_t n);
+
+
+/**
+* Convert n colors to 8-bit grayscale: (77*R + 150*G + 29*B)/256 on the 8-bit channels.
+**/
+void convertToGray(const RGB565* src, uint8_t* dst, size_t n);
+
+/** RGB24 to grayscale */
+void convertToGray(const RGB24* src, uint8_t* dst, size_t n);
+
+/** RGB32 to grayscale */
+void convertToGray(const RGB32* src, uint8_t* dst, size_t n);
+
+/** 8-bit grayscale to RGB565 */
+void convertFromGray(const uint8_t* src, RGB565* dst, size_t n);
+
+
 
 }
 
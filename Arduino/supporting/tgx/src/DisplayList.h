@@ -0,0 +1,629 @@
+/** @file DisplayList.h */
+//
+// Copyright 2020 Arvind Singh
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+//version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _TGX_DISPLAYLIST_H_
+#define _TGX_DISPLAYLIST_H_
+
+// only C++, no plain C
+#ifdef __cplusplus
+
+
+#include "Misc.h"
+#include "Vec2.h"
+#include "Box2.h"
+#include "Color.h"
+#include "Image.h"
+
+#include <stdint.h>
+
+
+namespace tgx
+{
+
+
+    /**
+    * Deferred list of 2D drawing commands executed tile by tile.
+    *
+    * Drawing directly onto a framebuffer located in slow memory (PSRAM on ESP32, EXTMEM on
+    * Teensy 4.1) is costly: each primitive touches its pixels at random and a pixel covered by
+    * several primitives is written several times. Instead, the commands are recorded together
+    * with their bounding box and, when the list is executed, the screen is split in tiles the
+    * size of a small scratch image located in fast memory. For each tile, only the commands
+    * whose bounding box intersects the tile are replayed onto the scratch image, which is then
+    * copied onto the framebuffer (or pushed to the screen) in a single sequential pass.
+    *
+    * Commands drawn before an opaque fillRect() / fillScreen() covering the whole tile are
+    * skipped: clearing the background and redrawing everything costs nothing for the hidden
+    * layers.
+    *
+    * Example:
+    *
+    *   DisplayList<RGB565> dl(256);                      // room for 256 commands
+    *   Image<RGB565> tile(tilebuf, 64, 32);              // scratch tile in internal RAM
+    *   ...
+    *   dl.fillScreen(RGB565_Black);
+    *   dl.blit(background, { 0, 0 });
+    *   dl.drawText("Score", { 10, 20 }, RGB565_White, font_tgx_Arial_16, false);
+    *   dl.execute(fb, tile);                             // fb is the framebuffer in PSRAM
+    *   dl.clear();
+    *
+    * Remarks:
+    * - Sprites, texts and fonts are referenced, not copied: they must stay valid until the
+    *   list is executed.
+    * - Recording methods return false when the list is full. The list can then be executed
+    *   and cleared before recording the remaining commands.
+    * - Anti-aliased primitives are drawn with their coordinates translated to the tile
+    *   so their sub-pixel position may differ by a rounding error from direct drawing.
+    **/
+    template<typename color_t> class DisplayList
+    {
+
+        // make sure right away that the template parameter is admissible to prevent cryptic error message later.
+        static_assert(is_color<color_t>::value, "color_t must be one of the color types defined in color.h");
+
+    public:
+
+
+        /**
+        * Counters accumulated since the last call to resetStats().
+        **/
+        struct Stats
+            {
+            uint32_t commands;      // commands executed (counted once per call to execute())
+            uint32_t tiles;         // tiles drawn
+            uint32_t draws;         // commands replayed onto a tile
+            uint32_t hidden;        // commands skipped because an opaque fill covers the tile
+            };
+
+
+        /**
+        * Constructor.
+        *
+        * - max_commands : capacity of the list.
+        * - use_extmem : true to allocate the list in external RAM.
+        **/
+        DisplayList(int max_commands, bool use_extmem = false) : _nb(0), _max(0)
+            {
+            _cmds = (_Cmd*)memAlloc(sizeof(_Cmd) * max_commands, (use_extmem) ? TGX_MEM_EXTMEM : TGX_MEM_INTERNAL);
+            if (_cmds) _max = max_commands;
+            resetStats();
+            }
+
+
+        /**
+        * Destructor.
+        **/
+        ~DisplayList()
+            {
+            memFree(_cmds);
+            }
+
+
+        DisplayList(const DisplayList&) = delete;
+        DisplayList& operator=(const DisplayList&) = delete;
+
+
+        /**
+        * Remove all the commands.
+        **/
+        void clear() { _nb = 0; }
+
+
+        /**
+        * Number of commands recorded.
+        **/
+        int size() const { return _nb; }
+
+
+        /**
+        * Maximum number of commands.
+        **/
+        int capacity() const { return _max; }
+
+
+        /**
+        * Return the counters accumulated since the last call to resetStats().
+        **/
+        Stats getStats() const { return _stats; }
+
+
+        /**
+        * Reset the counters.
+        **/
+        void resetStats()
+            {
+            _stats.commands = 0;
+            _stats.tiles = 0;
+            _stats.draws = 0;
+            _stats.hidden = 0;
+            }
+
+
+
+        /*****************************************************************************************
+        * Recording. Same parameters as the corresponding methods of Image.
+        ******************************************************************************************/
+
+
+        /** Record Image::fillScreen(color). */
+        bool fillScreen(color_t color)
+            {
+            return fillRect(iBox2(-32768, 32767, -32768, 32767), color);
+            }
+
+
+        /** Record Image::fillRect(B, color). */
+        bool fillRect(const iBox2& B, color_t color)
+            {
+            _Cmd* C = _add(_FILLRECT, B, false, 1.0f);
+            if (!C) return false;
+            C->col1 = color;
+            return true;
+            }
+
+
+        /** Record Image::fillRect(B, color, opacity). */
+        bool fillRect(const iBox2& B, color_t color, float opacity)
+            {
+            _Cmd* C = _add(_FILLRECT, B, true, opacity);
+            if (!C) return false;
+            C->col1 = color;
+            return true;
+            }
+
+
+        /** Record Image::drawRect(B, color). */
+        bool drawRect(const iBox2& B, color_t color)
+            {
+            _Cmd* C = _add(_DRAWRECT, B, false, 1.0f);
+            if (!C) return false;
+            C->col1 = color;
+            return true;
+            }
+
+
+        /** Record Image::drawRect(B, color, opacity). */
+        bool drawRect(const iBox2& B, color_t color, float opacity)
+            {
+            _Cmd* C = _add(_DRAWRECT, B, true, opacity);
+            if (!C) return false;
+            C->col1 = color;
+            return true;
+            }
+
+
+        /** Record Image::fillRoundRect(B, r, color). */
+        bool fillRoundRect(const iBox2& B, int r, color_t color)
+            {
+            _Cmd* C = _add(_FILLROUNDRECT, B, false, 1.0f);
+            if (!C) return false;
+            C->col1 = color;
+            C->r = r;
+            return true;
+            }
+
+
+        /** Record Image::fillRoundRect(B, r, color, opacity). */
+        bool fillRoundRect(const iBox2& B, int r, color_t color, float opacity)
+            {
+            _Cmd* C = _add(_FILLROUNDRECT, B, true, opacity);
+            if (!C) return false;
+            C->col1 = color;
+            C->r = r;
+            return true;
+            }
+
+
+        /** Record Image::drawLine(P1, P2, color). */
+        bool drawLine(iVec2 P1, iVec2 P2, color_t color)
+            {
+            return _line(P1, P2, color, false, 1.0f);
+            }
+
+
+        /** Record Image::drawLine(P1, P2, color, opacity). */
+        bool drawLine(iVec2 P1, iVec2 P2, color_t color, float opacity)
+            {
+            return _line(P1, P2, color, true, opacity);
+            }
+
+
+        /** Record Image::drawCircle(center, r, color). */
+        bool drawCircle(iVec2 center, int r, color_t color)
+            {
+            return _circle(_DRAWCIRCLE, center, r, color, color, false, 1.0f);
+            }
+
+
+        /** Record Image::drawCircle(center, r, color, opacity). */
+        bool drawCircle(iVec2 center, int r, color_t color, float opacity)
+            {
+            return _circle(_DRAWCIRCLE, center, r, color, color, true, opacity);
+            }
+
+
+        /** Record Image::fillCircle(center, r, interior_color, outline_color). */
+        bool fillCircle(iVec2 center, int r, color_t interior_color, color_t outline_color)
+            {
+            return _circle(_FILLCIRCLE, center, r, interior_color, outline_color, false, 1.0f);
+            }
+
+
+        /** Record Image::fillCircle(center, r, interior_color, outline_color, opacity). */
+        bool fillCircle(iVec2 center, int r, color_t interior_color, color_t outline_color, float opacity)
+            {
+            return _circle(_FILLCIRCLE, center, r, interior_color, outline_color, true, opacity);
+            }
+
+
+        /** Record Image::drawWideLine(PA, PB, wd, color, opacity). */
+        bool drawWideLine(fVec2 PA, fVec2 PB, float wd, color_t color, float opacity)
+            {
+            return _aa(_WIDELINE, PA, PB, wd, wd, color, opacity);
+            }
+
+
+        /** Record Image::drawWedgeLine(PA, PB, aw, bw, color, opacity). */
+        bool drawWedgeLine(fVec2 PA, fVec2 PB, float aw, float bw, color_t color, float opacity)
+            {
+            return _aa(_WEDGELINE, PA, PB, aw, bw, color, opacity);
+            }
+
+
+        /** Record Image::drawSpot(center, r, color, opacity). */
+        bool drawSpot(fVec2 center, float r, color_t color, float opacity)
+            {
+            return _aa(_WIDELINE, center, center, 2.0f * r, 2.0f * r, color, opacity);
+            }
+
+
+        /** Record Image::blit(sprite, upperleftpos). */
+        bool blit(const Image<color_t>& sprite, iVec2 upperleftpos)
+            {
+            return _blit(_BLIT, sprite, upperleftpos, color_t(), false, 1.0f);
+            }
+
+
+        /** Record Image::blit(sprite, upperleftpos, opacity). */
+        bool blit(const Image<color_t>& sprite, iVec2 upperleftpos, float opacity)
+            {
+            return _blit(_BLIT, sprite, upperleftpos, color_t(), true, opacity);
+            }
+
+
+        /** Record Image::blitMasked(sprite, transparent_color, upperleftpos, opacity). */
+        bool blitMasked(const Image<color_t>& sprite, color_t transparent_color, iVec2 upperleftpos, float opacity)
+            {
+            return _blit(_BLITMASKED, sprite, upperleftpos, transparent_color, true, opacity);
+            }
+
+
+        /** Record Image::drawText(text, pos, col, font, start_newline_at_0). */
+        bool drawText(const char* text, iVec2 pos, color_t col, const GFXfont& font, bool start_newline_at_0)
+            {
+            return _text(_TEXTGFX, text, pos, col, &font, Image<color_t>::measureText(text, pos, font, start_newline_at_0), start_newline_at_0, false, 1.0f);
+            }
+
+
+        /** Record Image::drawText(text, pos, col, font, start_newline_at_0, opacity). */
+        bool drawText(const char* text, iVec2 pos, color_t col, const GFXfont& font, bool start_newline_at_0, float opacity)
+            {
+            return _text(_TEXTGFX, text, pos, col, &font, Image<color_t>::measureText(text, pos, font, start_newline_at_0), start_newline_at_0, true, opacity);
+            }
+
+
+        /** Record Image::drawText(text, pos, col, font, start_newline_at_0). */
+        bool drawText(const char* text, iVec2 pos, color_t col, const ILI9341_t3_font_t& font, bool start_newline_at_0)
+            {
+            return _text(_TEXTILI, text, pos, col, &font, Image<color_t>::measureText(text, pos, font, start_newline_at_0), start_newline_at_0, false, 1.0f);
+            }
+
+
+        /** Record Image::drawText(text, pos, col, font, start_newline_at_0, opacity). */
+        bool drawText(const char* text, iVec2 pos, color_t col, const ILI9341_t3_font_t& font, bool start_newline_at_0, float opacity)
+            {
+            return _text(_TEXTILI, text, pos, col, &font, Image<color_t>::measureText(text, pos, font, start_newline_at_0), start_newline_at_0, true, opacity);
+            }
+
+
+
+        /*****************************************************************************************
+        * Execution.
+        ******************************************************************************************/
+
+
+        /**
+        * Execute the list onto dst using tile as scratch image (its size sets the size of the
+        * tiles). Each tile of dst is written once. Tiles that are not covered by an opaque fill
+        * are first read back from dst so that the commands are drawn over its content.
+        *
+        * The list is not cleared.
+        **/
+        void execute(Image<color_t>& dst, Image<color_t>& tile)
+            {
+            if ((!dst.isValid()) || (!tile.isValid())) return;
+            _stats.commands += _nb;
+            for (int ty = 0; ty < dst.ly(); ty += tile.ly())
+                {
+                for (int tx = 0; tx < dst.lx(); tx += tile.lx())
+                    {
+                    const iBox2 T(tx, tgx::min(tx + tile.lx(), dst.lx()) - 1, ty, tgx::min(ty + tile.ly(), dst.ly()) - 1);
+                    Image<color_t> im(tile, iBox2(0, T.lx() - 1, 0, T.ly() - 1));
+                    const int start = _firstCommand(T);
+                    if (start < 0) dst.blitBackward(im, { tx, ty });
+                    _drawTile(im, T, tgx::max(start, 0));
+                    dst.blit(im, { tx, ty });
+                    }
+                }
+            }
+
+
+        /**
+        * Execute the list on a screen of size 'size' using tile as scratch image (its size sets
+        * the size of the tiles). Tiles not covered by an opaque fill are first filled with
+        * bg_color. Each tile is then given to push(im, pos) which should send the image 'im'
+        * (a sub-image of tile) to the screen at position 'pos'.
+        *
+        * The list is not cleared.
+        **/
+        template<typename PUSHFUN> void execute(iVec2 size, Image<color_t>& tile, color_t bg_color, PUSHFUN push)
+            {
+            if (!tile.isValid()) return;
+            _stats.commands += _nb;
+            for (int ty = 0; ty < size.y; ty += tile.ly())
+                {
+                for (int tx = 0; tx < size.x; tx += tile.lx())
+                    {
+                    const iBox2 T(tx, tgx::min(tx + tile.lx(), size.x) - 1, ty, tgx::min(ty + tile.ly(), size.y) - 1);
+                    Image<color_t> im(tile, iBox2(0, T.lx() - 1, 0, T.ly() - 1));
+                    const int start = _firstCommand(T);
+                    if (start < 0) im.fillScreen(bg_color);
+                    _drawTile(im, T, tgx::max(start, 0));
+                    push((const Image<color_t>&)im, iVec2(tx, ty));
+                    }
+                }
+            }
+
+
+
+    private:
+
+
+        /** command types */
+        enum
+            {
+            _FILLRECT,
+            _DRAWRECT,
+            _FILLROUNDRECT,
+            _LINE,
+            _DRAWCIRCLE,
+            _FILLCIRCLE,
+            _WIDELINE,
+            _WEDGELINE,
+            _BLIT,
+            _BLITMASKED,
+            _TEXTGFX,
+            _TEXTILI
+            };
+
+
+        /** a recorded command */
+        struct _Cmd
+            {
+            iBox2 box;              // bounding box of the drawn pixels (the rectangle itself for rectangles)
+            uint8_t type;           // command type
+            bool blend;             // true for the version of the method with an opacity parameter
+            bool flag;              // start_newline_at_0 for texts
+            float opacity;          // opacity
+            color_t col1, col2;     // colors
+            iVec2 P1, P2;           // integer positions
+            int r;                  // radius
+            fVec2 A, B;             // floating point positions
+            float wa, wb;           // widths
+            const void* obj;        // sprite or text
+            const void* font;       // font
+            };
+
+
+        /** append a command, return nullptr if the list is full */
+        _Cmd* _add(int type, const iBox2& box, bool blend, float opacity)
+            {
+            if (_nb >= _max) return nullptr;
+            _Cmd* C = _cmds + (_nb++);
+            C->box = box;
+            C->type = (uint8_t)type;
+            C->blend = blend;
+            C->flag = false;
+            C->opacity = opacity;
+            return C;
+            }
+
+
+        bool _line(iVec2 P1, iVec2 P2, color_t color, bool blend, float opacity)
+            {
+            _Cmd* C = _add(_LINE, iBox2(tgx::min(P1.x, P2.x), tgx::max(P1.x, P2.x), tgx::min(P1.y, P2.y), tgx::max(P1.y, P2.y)), blend, opacity);
+            if (!C) return false;
+            C->P1 = P1;
+            C->P2 = P2;
+            C->col1 = color;
+            return true;
+            }
+
+
+        bool _circle(int type, iVec2 center, int r, color_t col1, color_t col2, bool blend, float opacity)
+            {
+            _Cmd* C = _add(type, iBox2(center.x - r, center.x + r, center.y - r, center.y + r), blend, opacity);
+            if (!C) return false;
+            C->P1 = center;
+            C->r = r;
+            C->col1 = col1;
+            C->col2 = col2;
+            return true;
+            }
+
+
+        bool _aa(int type, fVec2 PA, fVec2 PB, float wa, float wb, color_t color, float opacity)
+            {
+            const float ra = wa / 2.0f + 1.0f;
+            const float rb = wb / 2.0f + 1.0f;
+            const iBox2 box((int)floorf(fminf(PA.x - ra, PB.x - rb)), (int)ceilf(fmaxf(PA.x + ra, PB.x + rb)), (int)floorf(fminf(PA.y - ra, PB.y - rb)), (int)ceilf(fmaxf(PA.y + ra, PB.y + rb)));
+            _Cmd* C = _add(type, box, true, opacity);
+            if (!C) return false;
+            C->A = PA;
+            C->B = PB;
+            C->wa = wa;
+            C->wb = wb;
+            C->col1 = color;
+            return true;
+            }
+
+
+        bool _blit(int type, const Image<color_t>& sprite, iVec2 pos, color_t transparent_color, bool blend, float opacity)
+            {
+            if (!sprite.isValid()) return true; // nothing to draw
+            _Cmd* C = _add(type, iBox2(pos.x, pos.x + sprite.lx() - 1, pos.y, pos.y + sprite.ly() - 1), blend, opacity);
+            if (!C) return false;
+            C->obj = &sprite;
+            C->P1 = pos;
+            C->col1 = transparent_color;
+            return true;
+            }
+
+
+        bool _text(int type, const char* text, iVec2 pos, color_t col, const void* font, const iBox2& box, bool start_newline_at_0, bool blend, float opacity)
+            {
+            _Cmd* C = _add(type, box, blend, opacity);
+            if (!C) return false;
+            C->obj = text;
+            C->font = font;
+            C->P1 = pos;
+            C->col1 = col;
+            C->flag = start_newline_at_0;
+            return true;
+            }
+
+
+        /** index of the last opaque fill covering the tile T or -1 if there is none */
+        int _firstCommand(const iBox2& T)
+            {
+            for (int i = _nb - 1; i >= 0; i--)
+                {
+                const _Cmd& C = _cmds[i];
+                if ((C.type == _FILLRECT) && (!C.blend) && (C.box.contains(T)))
+                    {
+                    for (int j = 0; j < i; j++) { if (!(_cmds[j].box & T).isEmpty()) _stats.hidden++; }
+                    return i;
+                    }
+                }
+            return -1;
+            }
+
+
+        /** replay commands [start, _nb[ onto the image im corresponding to the tile T */
+        void _drawTile(Image<color_t>& im, const iBox2& T, int start)
+            {
+            _stats.tiles++;
+            const iVec2 o(T.minX, T.minY);
+            const fVec2 fo((float)T.minX, (float)T.minY);
+            for (int i = start; i < _nb; i++)
+                {
+                const _Cmd& C = _cmds[i];
+                if ((C.box & T).isEmpty()) continue;
+                _stats.draws++;
+                iBox2 B = C.box;
+                B -= o;
+                switch (C.type)
+                    {
+                    case _FILLRECT:
+                        if (C.blend) im.fillRect(B, C.col1, C.opacity); else im.fillRect(B, C.col1);
+                        break;
+                    case _DRAWRECT:
+                        if (C.blend) im.drawRect(B, C.col1, C.opacity); else im.drawRect(B, C.col1);
+                        break;
+                    case _FILLROUNDRECT:
+                        if (C.blend) im.fillRoundRect(B, C.r, C.col1, C.opacity); else im.fillRoundRect(B, C.r, C.col1);
+                        break;
+                    case _LINE:
+                        if (C.blend) im.drawLine(C.P1 - o, C.P2 - o, C.col1, C.opacity); else im.drawLine(C.P1 - o, C.P2 - o, C.col1);
+                        break;
+                    case _DRAWCIRCLE:
+                        if (C.blend) im.drawCircle(C.P1 - o, C.r, C.col1, C.opacity); else im.drawCircle(C.P1 - o, C.r, C.col1);
+                        break;
+                    case _FILLCIRCLE:
+                        if (C.blend) im.fillCircle(C.P1 - o, C.r, C.col1, C.col2, C.opacity); else im.fillCircle(C.P1 - o, C.r, C.col1, C.col2);
+                        break;
+                    case _WIDELINE:
+                        im.drawWideLine(C.A - fo, C.B - fo, C.wa, C.col1, C.opacity);
+                        break;
+                    case _WEDGELINE:
+                        im.drawWedgeLine(C.A - fo, C.B - fo, C.wa, C.wb, C.col1, C.opacity);
+                        break;
+                    case _BLIT:
+                        if (C.blend) im.blit(*((const Image<color_t>*)C.obj), C.P1 - o, C.opacity); else im.blit(*((const Image<color_t>*)C.obj), C.P1 - o);
+                        break;
+                    case _BLITMASKED:
+                        im.blitMasked(*((const Image<color_t>*)C.obj), C.col1, C.P1 - o, C.opacity);
+                        break;
+                    case _TEXTGFX:
+                        _drawText(im, C, *((const GFXfont*)C.font), ((const GFXfont*)C.font)->yAdvance, o);
+                        break;
+                    case _TEXTILI:
+                        _drawText(im, C, *((const ILI9341_t3_font_t*)C.font), ((const ILI9341_t3_font_t*)C.font)->line_space, o);
+                        break;
+                    }
+                }
+            }
+
+
+        /** same as Image::drawText() but with newlines restarting at the right place inside the tile */
+        template<typename FONT_T> static void _drawText(Image<color_t>& im, const _Cmd& C, const FONT_T& font, int line_space, iVec2 o)
+            {
+            const char* text = (const char*)C.obj;
+            iVec2 pos = C.P1 - o;
+            const int startx = (C.flag) ? -o.x : pos.x;
+            for (; *text; text++)
+                {
+                if (*text == '\n')
+                    {
+                    pos.x = startx;
+                    pos.y += line_space;
+                    }
+                else
+                    {
+                    pos = (C.blend) ? im.drawChar(*text, pos, C.col1, font, C.opacity) : im.drawChar(*text, pos, C.col1, font);
+                    }
+                }
+            }
+
+
+        _Cmd*   _cmds;      // recorded commands
+        int     _nb;        // number of commands
+        int     _max;       // capacity
+        Stats   _stats;     // usage counters
+
+    };
+
+
+}
+
+
+#endif
+
+#endif
+
+/** end of file **/
+
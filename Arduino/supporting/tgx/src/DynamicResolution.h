@@ -0,0 +1,163 @@
+/** @file DynamicResolution.h */
+//
+// Copyright 2020 Arvind Singh
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+//version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _TGX_DYNAMICRESOLUTION_H_
+#define _TGX_DYNAMICRESOLUTION_H_
+
+// only C++, no plain C
+#ifdef __cplusplus
+
+
+#include "Misc.h"
+#include "Vec2.h"
+
+#include <stdint.h>
+#include <math.h>
+
+namespace tgx
+{
+
+
+    /**
+    * Frame time controller for dynamic resolution rendering.
+    *
+    * The object is given the time taken by the last frame and returns the size at which
+    * the next frame should be rendered in order to hold a target frame time. The returned
+    * size is meant to be passed to Renderer3D::setViewportSize() and the rendered image is
+    * then upscaled to the screen.
+    *
+    * The rendering time is assumed to be roughly proportional to the number of pixels. The
+    * controller corrects the pixel count multiplicatively but limits the change per frame
+    * (downscaling reacts faster than upscaling) and ignores small errors so that the
+    * resolution does not oscillate from one frame to the next.
+    *
+    * Example:
+    *
+    *   DynamicResolution dynres(160, 240, 33.3f);     // max size 160x240, target 30fps
+    *   ...
+    *   renderer.setViewportSize(dynres.size());       // for each frame
+    *   im.set(fb, dynres.size());                     // image (and zbuffer) of the same size
+    *   ... draw the frame ...
+    *   dynres.update(frame_time_ms);
+    **/
+    class DynamicResolution
+    {
+
+    public:
+
+        /**
+        * Constructor.
+        *
+        * - (maxlx, maxly) : maximum rendering size (usually the viewport size LX x LY of the renderer).
+        * - target_ms : target frame time in milliseconds.
+        * - min_scale : smallest allowed scaling factor (in each direction) w.r.t. the maximum size.
+        * - step : width and height are rounded down to multiples of this value.
+        **/
+        DynamicResolution(int maxlx, int maxly, float target_ms, float min_scale = 0.5f, int step = 4)
+            : _maxlx(maxlx), _maxly(maxly), _step((step < 1) ? 1 : step), _scale(1.0f)
+            {
+            setTarget(target_ms);
+            setMinScale(min_scale);
+            _computeSize();
+            }
+
+
+        /**
+        * Set the target frame time in milliseconds.
+        **/
+        void setTarget(float target_ms)
+            {
+            _target_ms = (target_ms > 0.0f) ? target_ms : 1.0f;
+            }
+
+
+        /**
+        * Set the smallest allowed scaling factor (in ]0,1]).
+        **/
+        void setMinScale(float min_scale)
+            {
+            _min_scale = tgx::clamp(min_scale, 0.05f, 1.0f);
+            _scale = tgx::clamp(_scale, _min_scale, 1.0f);
+            }
+
+
+        /**
+        * Give the duration of the last frame (in milliseconds) and return the size to use for the
+        * next frame.
+        **/
+        iVec2 update(float frame_ms)
+            {
+            if (frame_ms <= 0.0f) return size();
+            const float r = _target_ms / frame_ms;  // > 1 : we have time left
+            if ((r > 0.95f) && (r < 1.05f)) return size(); // close enough: do not change anything
+            // pixel count proportional to time so the scale (in each direction) goes as sqrt(r)
+            const float f = tgx::clamp(sqrtf(r), 0.80f, 1.05f);
+            _scale = tgx::clamp(_scale * f, _min_scale, 1.0f);
+            _computeSize();
+            return size();
+            }
+
+
+        /**
+        * Return the size to use for the next frame.
+        **/
+        iVec2 size() const
+            {
+            return iVec2(_lx, _ly);
+            }
+
+
+        /**
+        * Return the current scaling factor (in each direction) w.r.t the maximum size.
+        **/
+        float scale() const
+            {
+            return _scale;
+            }
+
+
+    private:
+
+
+        void _computeSize()
+            {
+            _lx = tgx::max(_step, (((int)(_maxlx * _scale)) / _step) * _step);
+            _ly = tgx::max(_step, (((int)(_maxly * _scale)) / _step) * _step);
+            if (_lx > _maxlx) _lx = _maxlx;
+            if (_ly > _maxly) _ly = _maxly;
+            }
+
+
+        int     _maxlx, _maxly;     // maximum size
+        int     _step;              // size granularity
+        int     _lx, _ly;           // current size
+        float   _scale;             // current scaling factor
+        float   _min_scale;         // minimum scaling factor
+        float   _target_ms;         // target frame time
+
+    };
+
+
+}
+
+
+#endif
+
+#endif
+
+/** end of file **/
+
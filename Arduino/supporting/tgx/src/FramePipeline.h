@@ -0,0 +1,367 @@
+/** @file FramePipeline.h */
+//
+// Copyright 2020 Arvind Singh
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+//version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _TGX_FRAMEPIPELINE_H_
+#define _TGX_FRAMEPIPELINE_H_
+
+// only C++, no plain C
+#ifdef __cplusplus
+
+
+#include "Misc.h"
+#include "Vec2.h"
+#include "Image.h"
+
+#include <stdint.h>
+
+
+// The pipeline needs a way for a task to block until another one wakes it up:
+// FreeRTOS queues on ESP32 and the standard thread library on a computer.
+#if defined(ESP32)
+    #include "freertos/FreeRTOS.h"
+    #include "freertos/queue.h"
+    #include "esp_timer.h"
+    #define TGX_HAS_FRAMEPIPELINE
+#elif !defined(TGX_ON_ARDUINO)
+    #include <mutex>
+    #include <condition_variable>
+    #include <chrono>
+    #define TGX_HAS_FRAMEPIPELINE
+#endif
+
+
+#ifdef TGX_HAS_FRAMEPIPELINE
+
+namespace tgx
+{
+
+
+    /**
+    * Hand-off of frames between a rendering task and a display task.
+    *
+    * The pipeline owns N framebuffers (and the zbuffer used by the rendering task). Each
+    * framebuffer is either free (waiting to be drawn onto) or ready (waiting to be displayed).
+    * Both tasks block until the other one hands them a framebuffer so there is no polling:
+    * the display task starts as soon as a frame is submitted and the rendering task starts
+    * as soon as a framebuffer is released.
+    *
+    * Rendering task:                               Display task:
+    *
+    *   Image<RGB565>* im = pipeline.acquire();       const Image<RGB565>* im = pipeline.next();
+    *   renderer.setImage(im);                        ... push im to the screen ...
+    *   renderer.setZbuffer(pipeline.zbuffer(), ..)   pipeline.release(im);
+    *   ... draw ...
+    *   pipeline.submit(im);
+    *
+    * Frames are displayed in the order they are submitted. The time spent working and waiting
+    * in each stage is accumulated and can be queried with getStats().
+    *
+    * Implemented with FreeRTOS queues on ESP32 and with std::mutex/std::condition_variable on
+    * a computer (not available on other MCUs).
+    **/
+    template<typename color_t, int N = 2> class FramePipeline
+    {
+
+        static_assert(N >= 1, "at least one framebuffer is needed");
+
+    public:
+
+
+        /**
+        * Per stage timings, in microseconds, accumulated since the last call to resetStats().
+        **/
+        struct Stats
+            {
+            uint32_t frames;            // number of frames released by the display task
+            uint64_t render_us;         // time between acquire() and submit()
+            uint64_t render_wait_us;    // time blocked in acquire()
+            uint64_t display_us;        // time between next() and release()
+            uint64_t display_wait_us;   // time blocked in next()
+            };
+
+
+        /**
+        * Constructor. begin() must be called before use.
+        **/
+        FramePipeline() : _lx(0), _ly(0), _zbuf(nullptr), _zbuf_len(0)
+            {
+            for (int i = 0; i < N; i++) { _buf[i] = nullptr; _start[i] = 0; }
+            resetStats();
+            }
+
+
+        /**
+        * Set the framebuffers (N buffers of at least lx*ly pixels) and the zbuffer (may be
+        * nullptr when not needed). All the framebuffers are initially free.
+        *
+        * Must be called once, before the tasks start using the pipeline.
+        **/
+        void begin(color_t* const buffers[N], int lx, int ly, float* zbuf = nullptr, int zbuf_len = 0)
+            {
+            _lx = lx;
+            _ly = ly;
+            _zbuf = zbuf;
+            _zbuf_len = zbuf_len;
+            for (int i = 0; i < N; i++)
+                {
+                _buf[i] = buffers[i];
+                _im[i].set(_buf[i], _lx, _ly);
+                _free.push(i);
+                }
+            }
+
+
+        /**
+        * Rendering task: wait until a framebuffer is free and return it (as an image of the
+        * full size).
+        **/
+        Image<color_t>* acquire()
+            {
+            return acquire(_lx, _ly);
+            }
+
+
+        /**
+        * Rendering task: wait until a framebuffer is free and return it as an image of size
+        * (lx, ly) (which must not exceed the size given to begin()).
+        **/
+        Image<color_t>* acquire(int lx, int ly)
+            {
+            const uint64_t t0 = _now_us();
+            const int i = _free.pop();
+            const uint64_t t1 = _now_us();
+            _lockStats();
+            _stats.render_wait_us += (t1 - t0);
+            _unlockStats();
+            _start[i] = t1;
+            _im[i].set(_buf[i], min(lx, _lx), min(ly, _ly));
+            return &(_im[i]);
+            }
+
+
+        /**
+        * Same as above but in vector form.
+        **/
+        Image<color_t>* acquire(const iVec2& size)
+            {
+            return acquire(size.x, size.y);
+            }
+
+
+        /**
+        * Rendering task: hand a frame obtained with acquire() to the display task.
+        **/
+        void submit(Image<color_t>* im)
+            {
+            const int i = _index(im);
+            const uint64_t dt = _now_us() - _start[i];
+            _lockStats();
+            _stats.render_us += dt;
+            _unlockStats();
+            _ready.push(i);
+            }
+
+
+        /**
+        * Display task: wait until a frame is submitted and return it.
+        **/
+        const Image<color_t>* next()
+            {
+            const uint64_t t0 = _now_us();
+            const int i = _ready.pop();
+            const uint64_t t1 = _now_us();
+            _lockStats();
+            _stats.display_wait_us += (t1 - t0);
+            _unlockStats();
+            _start[i] = t1;
+            return &(_im[i]);
+            }
+
+
+        /**
+        * Display task: give back a frame obtained with next() once it has been displayed.
+        **/
+        void release(const Image<color_t>* im)
+            {
+            const int i = _index(im);
+            const uint64_t dt = _now_us() - _start[i];
+            _lockStats();
+            _stats.display_us += dt;
+            _stats.frames++;
+            _unlockStats();
+            _free.push(i);
+            }
+
+
+        /**
+        * Zbuffer of the rendering task (as given to begin()).
+        **/
+        float* zbuffer() const { return _zbuf; }
+
+
+        /**
+        * Size of the zbuffer (as given to begin()).
+        **/
+        int zbufferLen() const { return _zbuf_len; }
+
+
+        /**
+        * Return the timings accumulated since the last call to resetStats(). Can be called
+        * from any task: the counters are updated and read under a lock so the snapshot is
+        * consistent.
+        **/
+        Stats getStats() const
+            {
+            _lockStats();
+            const Stats S = _stats;
+            _unlockStats();
+            return S;
+            }
+
+
+        /**
+        * Reset the timings. Can be called from any task.
+        **/
+        void resetStats()
+            {
+            _lockStats();
+            _stats.frames = 0;
+            _stats.render_us = 0;
+            _stats.render_wait_us = 0;
+            _stats.display_us = 0;
+            _stats.display_wait_us = 0;
+            _unlockStats();
+            }
+
+
+    private:
+
+
+        /** blocking fifo of framebuffer indices (at most N elements) */
+        class _Fifo
+            {
+            public:
+
+        #if defined(ESP32)
+
+                _Fifo() { _q = xQueueCreate(N, sizeof(int)); }
+
+                ~_Fifo() { vQueueDelete(_q); }
+
+                void push(int i) { xQueueSend(_q, &i, portMAX_DELAY); }
+
+                int pop() { int i = 0; xQueueReceive(_q, &i, portMAX_DELAY); return i; }
+
+            private:
+
+                QueueHandle_t _q;
+
+        #else
+
+                _Fifo() : _first(0), _nb(0) {}
+
+                void push(int i)
+                    {
+                    std::unique_lock<std::mutex> lock(_m);
+                    _cv.wait(lock, [this] { return _nb < N; });
+                    _tab[(_first + _nb) % N] = i;
+                    _nb++;
+                    _cv.notify_all();
+                    }
+
+                int pop()
+                    {
+                    std::unique_lock<std::mutex> lock(_m);
+                    _cv.wait(lock, [this] { return _nb > 0; });
+                    const int i = _tab[_first];
+                    _first = (_first + 1) % N;
+                    _nb--;
+                    _cv.notify_all();
+                    return i;
+                    }
+
+            private:
+
+                std::mutex _m;
+                std::condition_variable _cv;
+                int _tab[N];
+                int _first, _nb;
+
+        #endif
+            };
+
+
+        /** current time in microseconds */
+        static uint64_t _now_us()
+            {
+        #if defined(ESP32)
+            return (uint64_t)esp_timer_get_time();
+        #else
+            return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        #endif
+            }
+
+
+        /**
+        * Lock protecting _stats: the two tasks (which may run on different cores) and the
+        * caller of getStats()/resetStats() all update or read the 64-bit counters. Held only
+        * for a few instructions.
+        **/
+    #if defined(ESP32)
+        void _lockStats() const { portENTER_CRITICAL(&_stats_mux); }
+        void _unlockStats() const { portEXIT_CRITICAL(&_stats_mux); }
+    #else
+        void _lockStats() const { _stats_mux.lock(); }
+        void _unlockStats() const { _stats_mux.unlock(); }
+    #endif
+
+
+        /** index of the framebuffer of an image returned by acquire() or next() */
+        int _index(const Image<color_t>* im) const
+            {
+            return (int)(im - _im);
+            }
+
+
+        int             _lx, _ly;       // size of the framebuffers
+        color_t*        _buf[N];        // framebuffers
+        Image<color_t>  _im[N];         // images encapsulating the framebuffers
+        uint64_t        _start[N];      // time when the current stage started working on each framebuffer
+        float*          _zbuf;          // zbuffer of the rendering task
+        int             _zbuf_len;      // size of the zbuffer
+        _Fifo           _free;          // framebuffers waiting to be drawn onto
+        _Fifo           _ready;         // framebuffers waiting to be displayed
+        Stats           _stats;         // accumulated timings
+    #if defined(ESP32)
+        mutable portMUX_TYPE _stats_mux = portMUX_INITIALIZER_UNLOCKED;  // spinlock for _stats (both cores)
+    #else
+        mutable std::mutex _stats_mux;  // lock for _stats
+    #endif
+
+    };
+
+
+}
+
+#endif
+
+#endif
+
+#endif
+
+/** end of file **/
+
@@ -0,0 +1,414 @@
+/** @file GlyphCache.h */
+//
+// Copyright 2020 Arvind Singh
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+//version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _TGX_GLYPHCACHE_H_
+#define _TGX_GLYPHCACHE_H_
+
+// only C++, no plain C
+#ifdef __cplusplus
+
+
+#include "Misc.h"
+#include "Vec2.h"
+#include "Color.h"
+#include "Image.h"
+#include "Fonts.h"
+
+#include <stdint.h>
+#include <string.h>
+
+
+namespace tgx
+{
+
+
+    /**
+    * Cache of decoded glyphs for ILI9341_t3 fonts (v1 and antialiased v23).
+    *
+    * Drawing a char with Image::drawChar() decodes the glyph header and unpacks its bitmap
+    * each time. The cache decodes each glyph once into an atlas of coverage values (one
+    * byte per pixel) and then draws text directly from the atlas. The atlas does not depend
+    * on the color so the same glyphs serve every color and opacity, and the result is
+    * identical to Image::drawText().
+    *
+    * The atlas is a single buffer of 'budget' bytes allocated on first use. Glyphs are
+    * looked up in a direct mapped table of MAXGLYPHS entries: a glyph replaces the one
+    * stored in its entry and, when the atlas is full, all the glyphs are flushed.
+    *
+    * Example:
+    *
+    *   GlyphCache gcache(8000);                                    // 8KB atlas in internal RAM
+    *   ...
+    *   gcache.drawText(im, "12.5 km/h", { 10, 40 }, RGB565_White, font_Arial_24);
+    *   ...
+    *   auto st = gcache.getStats();                                // hits/misses to adjust the budget
+    *
+    * The cache is not thread safe.
+    **/
+    class GlyphCache
+    {
+
+    public:
+
+        /** number of entries of the glyph table (must be a power of 2) */
+        static const int MAXGLYPHS = 128;
+
+
+        /**
+        * Cache usage counters, accumulated since the last call to resetStats().
+        **/
+        struct Stats
+            {
+            uint32_t hits;          // glyphs found in the cache
+            uint32_t misses;        // glyphs that had to be decoded
+            uint32_t evictions;     // glyphs replaced by another one using the same entry
+            uint32_t flushes;       // number of times the atlas was full and all glyphs were dropped
+            uint32_t failures;      // glyphs too large for the atlas (drawn with Image::drawChar() instead)
+            };
+
+
+        /**
+        * Constructor.
+        *
+        * - budget : size in bytes of the atlas (each glyph uses width x height bytes).
+        * - use_extmem : true to allocate the atlas in external RAM (PSRAM on ESP32, EXTMEM
+        *                on Teensy 4.1) and false to use internal RAM.
+        **/
+        GlyphCache(size_t budget, bool use_extmem = false) : _atlas(nullptr), _budget(budget), _used(0), _extmem(use_extmem)
+            {
+            for (int i = 0; i < MAXGLYPHS; i++) _glyphs[i].font = nullptr;
+            resetStats();
+            }
+
+
+        /**
+        * Destructor. Release the atlas.
+        **/
+        ~GlyphCache()
+            {
+            if (_atlas) memFree(_atlas);
+            }
+
+
+        /**
+        * Draw a char at position pos (w.r.t. the baseline) on an image. Return the position
+        * for the next char on the same line. Same as Image::drawChar().
+        **/
+        template<typename color_t> iVec2 drawChar(Image<color_t>& im, char c, iVec2 pos, color_t col, const ILI9341_t3_font_t& font)
+            {
+            return _drawChar<false>(im, c, pos, col, font, 1.0f);
+            }
+
+
+        /**
+        * Draw a char blended with opacity in [0.0f, 1.0f]. Same as Image::drawChar().
+        **/
+        template<typename color_t> iVec2 drawChar(Image<color_t>& im, char c, iVec2 pos, color_t col, const ILI9341_t3_font_t& font, float opacity)
+            {
+            return _drawChar<true>(im, c, pos, col, font, opacity);
+            }
+
+
+        /**
+        * Draw a text starting at position pos (w.r.t. the baseline) on an image. Return the
+        * position after the last char. Same as Image::drawText().
+        **/
+        template<typename color_t> iVec2 drawText(Image<color_t>& im, const char* text, iVec2 pos, color_t col, const ILI9341_t3_font_t& font, bool start_newline_at_0)
+            {
+            return _drawText<false>(im, text, pos, col, font, start_newline_at_0, 1.0f);
+            }
+
+
+        /**
+        * Draw a text blended with opacity in [0.0f, 1.0f]. Same as Image::drawText().
+        **/
+        template<typename color_t> iVec2 drawText(Image<color_t>& im, const char* text, iVec2 pos, color_t col, const ILI9341_t3_font_t& font, bool start_newline_at_0, float opacity)
+            {
+            return _drawText<true>(im, text, pos, col, font, start_newline_at_0, opacity);
+            }
+
+
+        /**
+        * Drop all the glyphs.
+        **/
+        void clear()
+            {
+            for (int i = 0; i < MAXGLYPHS; i++) _glyphs[i].font = nullptr;
+            _used = 0;
+            }
+
+
+        /**
+        * Return the size of the atlas in bytes.
+        **/
+        size_t budget() const { return _budget; }
+
+
+        /**
+        * Return the number of bytes of the atlas currently used.
+        **/
+        size_t usedBytes() const { return _used; }
+
+
+        /**
+        * Return the counters accumulated since the last call to resetStats().
+        **/
+        Stats getStats() const { return _stats; }
+
+
+        /**
+        * Reset the counters.
+        **/
+        void resetStats()
+            {
+            _stats.hits = 0;
+            _stats.misses = 0;
+            _stats.evictions = 0;
+            _stats.flushes = 0;
+            _stats.failures = 0;
+            }
+
+
+    private:
+
+
+        /** a decoded glyph */
+        struct _Glyph
+            {
+            const ILI9341_t3_font_t* font;  // font of the glyph (nullptr if the entry is empty)
+            uint32_t offset;                // position of the coverage values in the atlas
+            int16_t sx, sy;                 // bitmap size
+            int16_t xoffset, yoffset;       // bitmap position w.r.t. the cursor
+            int16_t delta;                  // cursor advance
+            uint8_t n;                      // index of the char in the font
+            uint8_t bpp;                    // 0 = 1 bit (v1 or v23), 1 = 2 bits, 2 = 4 bits, 3 = 8 bits
+            };
+
+
+        /** same as Image::_fetchbits_unsigned() */
+        static uint32_t _fetchbits_unsigned(const uint8_t* p, uint32_t index, uint32_t required)
+            {
+            const uint8_t* s = &p[index >> 3];
+            uint32_t val = (((uint32_t)s[0]) << 24) | (((uint32_t)s[1]) << 16) | (((uint32_t)s[2]) << 8) | ((uint32_t)s[3]);
+            val <<= (index & 7);
+            if (32 - (index & 7) < required) val |= (s[4] >> (8 - (index & 7)));
+            return (val >> (32 - required));
+            }
+
+
+        /** same as Image::_fetchbits_signed() */
+        static int32_t _fetchbits_signed(const uint8_t* p, uint32_t index, uint32_t required)
+            {
+            const uint32_t val = _fetchbits_unsigned(p, index, required);
+            if (val & (1 << (required - 1))) return (int32_t)val - (1 << required);
+            return (int32_t)val;
+            }
+
+
+        /** index of a char in a font or -1 if the font does not contain it */
+        static int _charIndex(char c, const ILI9341_t3_font_t& font)
+            {
+            const uint8_t n = (uint8_t)c;
+            if ((n >= font.index1_first) && (n <= font.index1_last)) return (uint8_t)(n - font.index1_first);
+            if ((n >= font.index2_first) && (n <= font.index2_last)) return (uint8_t)((n - font.index2_first) + (font.index1_last - font.index1_first + 1));
+            return -1;
+            }
+
+
+        /** return the decoded glyph for index n of a font (decoding it if needed) or nullptr if it cannot be cached */
+        const _Glyph* _get(int n, const ILI9341_t3_font_t& font)
+            {
+            _Glyph& G = _glyphs[((((uintptr_t)&font) >> 2) * 31 + n) & (MAXGLYPHS - 1)];
+            if ((G.font == &font) && (G.n == n))
+                {
+                _stats.hits++;
+                return &G;
+                }
+            _stats.misses++;
+            if ((font.version != 1) && (font.version != 23)) { _stats.failures++; return nullptr; }
+            const uint8_t* data = font.data + _fetchbits_unsigned(font.index, (n * font.bits_index), font.bits_index);
+            uint32_t off = 0;
+            if (_fetchbits_unsigned(data, off, 3) != 0) { _stats.failures++; return nullptr; } // wrong/unsupported format
+            off += 3;
+            const int sx = (int)_fetchbits_unsigned(data, off, font.bits_width);
+            off += font.bits_width;
+            const int sy = (int)_fetchbits_unsigned(data, off, font.bits_height);
+            off += font.bits_height;
+            const int xoffset = (int)_fetchbits_signed(data, off, font.bits_xoffset);
+            off += font.bits_xoffset;
+            const int yoffset = (int)_fetchbits_signed(data, off, font.bits_yoffset);
+            off += font.bits_yoffset;
+            const int delta = (int)_fetchbits_unsigned(data, off, font.bits_delta);
+            off += font.bits_delta;
+            const size_t size = (size_t)sx * (size_t)sy;
+            if (size > _budget) { _stats.failures++; return nullptr; }
+            if (_atlas == nullptr)
+                {
+                _atlas = (uint8_t*)memAlloc(_budget, (_extmem) ? TGX_MEM_EXTMEM : TGX_MEM_INTERNAL);
+                if (_atlas == nullptr) { _stats.failures++; return nullptr; }
+                }
+            if (_used + size > _budget)
+                { // atlas full: start over
+                clear();
+                _stats.flushes++;
+                }
+            else if (G.font != nullptr)
+                {
+                _stats.evictions++;
+                }
+            G.font = &font;
+            G.n = (uint8_t)n;
+            G.sx = (int16_t)sx;
+            G.sy = (int16_t)sy;
+            G.xoffset = (int16_t)xoffset;
+            G.yoffset = (int16_t)yoffset;
+            G.delta = (int16_t)delta;
+            G.offset = (uint32_t)_used;
+            G.bpp = (font.version == 1) ? 0 : (font.reserved & 3);
+            uint8_t* dst = _atlas + _used;
+            _used += size;
+            if (font.version == 1)
+                _decodeV1(data, off, sx, sy, dst);
+            else
+                _decodeV23(data + (off >> 3) + ((off & 7) ? 1 : 0), G.bpp, sx, sy, dst);
+            return &G;
+            }
+
+
+        /** decode the bitmap of a non-antialiased (v1) glyph: 1 bit per pixel with repeated lines */
+        static void _decodeV1(const uint8_t* bitmap, uint32_t off, int sx, int sy, uint8_t* dst)
+            {
+            int y = 0;
+            while (y < sy)
+                {
+                int rl = 1;
+                if (_fetchbits_unsigned(bitmap, off++, 1))
+                    { // repeating line
+                    rl = (int)_fetchbits_unsigned(bitmap, off, 3) + 2;
+                    off += 3;
+                    }
+                for (int x = 0; x < sx; x++) dst[x] = (uint8_t)((bitmap[(off + x) >> 3] >> (7 - ((off + x) & 7))) & 1);
+                off += sx;
+                for (int k = 1; (k < rl) && (y + k < sy); k++) memcpy(dst + k * sx, dst, sx);
+                dst += rl * sx;
+                y += rl;
+                }
+            }
+
+
+        /** decode the bitmap of an antialiased (v23) glyph: 1, 2, 4 or 8 bits per pixel */
+        static void _decodeV23(const uint8_t* bitmap, int bpp, int sx, int sy, uint8_t* dst)
+            {
+            const int n = sx * sy;
+            for (int i = 0; i < n; i++)
+                {
+                switch (bpp)
+                    {
+                    case 0: dst[i] = (uint8_t)((bitmap[i >> 3] >> (7 - (i & 7))) & 1); break;
+                    case 1: dst[i] = (uint8_t)((bitmap[i >> 2] >> (6 - 2 * (i & 3))) & 3); break;
+                    case 2: dst[i] = (uint8_t)((bitmap[i >> 1] >> ((i & 1) ? 0 : 4)) & 15); break;
+                    default: dst[i] = bitmap[i]; break;
+                    }
+                }
+            }
+
+
+        template<bool BLEND, typename color_t> iVec2 _drawChar(Image<color_t>& im, char c, iVec2 pos, color_t col, const ILI9341_t3_font_t& font, float opacity)
+            {
+            if (!im.isValid()) return pos;
+            const int n = _charIndex(c, font);
+            if (n < 0) return pos;
+            const _Glyph* G = _get(n, font);
+            if (G == nullptr)
+                { // not cached: use the regular method
+                return (BLEND) ? im.drawChar(c, pos, col, font, opacity) : im.drawChar(c, pos, col, font);
+                }
+            const iVec2 next(pos.x + G->delta, pos.y);
+            // clip the glyph box
+            const int x = pos.x + G->xoffset;
+            const int y = pos.y - G->sy - G->yoffset;
+            const int x0 = tgx::max(0, -x);
+            const int x1 = tgx::min((int)G->sx, im.lx() - x);
+            const int y0 = tgx::max(0, -y);
+            const int y1 = tgx::min((int)G->sy, im.ly() - y);
+            if ((x0 >= x1) || (y0 >= y1)) return next;
+            // same alpha computation as Image::_drawCharBitmap_xBPP()
+            static const int mult[4] = { 0, 171, 137, 129 };
+            static const int shift[4] = { 0, 9, 11, 15 };
+            const int iop = mult[G->bpp] * (int)(256 * opacity);
+            const int sh = shift[G->bpp];
+            const uint8_t* src = _atlas + G->offset + y0 * G->sx;
+            for (int j = y0; j < y1; j++)
+                {
+                color_t* p = im.data() + TGX_CAST32(y + j) * TGX_CAST32(im.stride()) + TGX_CAST32(x);
+                for (int i = x0; i < x1; i++)
+                    {
+                    const int v = src[i];
+                    if (v == 0) continue;
+                    if (G->bpp == 0)
+                        {
+                        if (BLEND) p[i].blend(col, opacity); else p[i] = col;
+                        }
+                    else
+                        {
+                        p[i].blend256(col, (v * iop) >> sh);
+                        }
+                    }
+                src += G->sx;
+                }
+            return next;
+            }
+
+
+        template<bool BLEND, typename color_t> iVec2 _drawText(Image<color_t>& im, const char* text, iVec2 pos, color_t col, const ILI9341_t3_font_t& font, bool start_newline_at_0, float opacity)
+            {
+            const int startx = start_newline_at_0 ? 0 : pos.x;
+            for (const char* t = text; *t; t++)
+                {
+                if (*t == '\n')
+                    {
+                    pos.x = startx;
+                    pos.y += font.line_space;
+                    }
+                else
+                    {
+                    pos = _drawChar<BLEND>(im, *t, pos, col, font, opacity);
+                    }
+                }
+            return pos;
+            }
+
+
+        uint8_t*    _atlas;                 // coverage values of the glyphs
+        size_t      _budget;                // size of the atlas
+        size_t      _used;                  // number of bytes of the atlas in use
+        bool        _extmem;                // true to allocate the atlas in external RAM
+        _Glyph      _glyphs[MAXGLYPHS];     // glyph table
+        Stats       _stats;                 // usage counters
+
+    };
+
+
+}
+
+
+#endif
+
+#endif
+
+/** end of file **/
+
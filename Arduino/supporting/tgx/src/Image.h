@@ -28,6 +28,7 @@
 #include "Vec4.h"
 #include "Box2.h"
 #include "Color.h"
+#include "Simd.h"
 #include "ShaderParams.h"
 #include "Shaders.h"
 #include "Rasterizer.h"
@@ -35,6 +36,13 @@
 #include <stdint.h>
 
 
+// Wide lines, wedges and spots whose (largest) radius is at least this value are drawn
+// with solid interior spans. Smaller ones use the per-pixel scan, which is faster for them.
+#ifndef TGX_AALINE_SPANS_MIN_RADIUS
+#define TGX_AALINE_SPANS_MIN_RADIUS (5)
+#endif
+
+
 namespace tgx
 {
 
@@ -754,6 +762,12 @@ namespace tgx
          * 3. The sprite image can have a different color type from this image.
          * 4. This version does NOT use blending: pixel from the source are simply copied over this
          *    image.
+         * 5. When 'scale' is an integer (1, 2, 3...), 'angle_degrees' is a multiple of 90 and the
+         *    image of the upper left corner of the sprite has integer coordinates in this
+         *    image, a faster axis-aligned path is used: each pixel whose center lies inside the
+         *    transformed sprite takes the color of the sprite pixel under that center. This differs
+         *    from the bilinear sampling used for other parameters (and by previous versions for
+         *    these ones) on about 10% of the pixels at scale 1 and up to 40% at scale 3.
          * 
          * Note: When rotated, access to  the sprite pixels colors is not linear anymore. For certain
          *       orientations, this will yield very 'irregular' access to the sprite memory locations.
@@ -792,6 +806,12 @@ namespace tgx
          * 4. This version use blending and opacity. If the sprite image color type has an alpha channel,
          *    then it is used for blending and multiplied by the opacity factor (even if this image does
          *    not have an alpha channel).
+         * 5. When 'scale' is an integer (1, 2, 3...), 'angle_degrees' is a multiple of 90 and the
+         *    image of the upper left corner of the sprite has integer coordinates in this
+         *    image, a faster axis-aligned path is used: each pixel whose center lies inside the
+         *    transformed sprite takes the color of the sprite pixel under that center. This differs
+         *    from the bilinear sampling used for other parameters (and by previous versions for
+         *    these ones) on about 10% of the pixels at scale 1 and up to 40% at scale 3.
          * 
          * Note: When rotated, access to  the sprite pixels colors is not linear anymore. For certain
          *       orientations, this will yield very 'irregular' access to the sprite memory locations.
@@ -834,6 +854,12 @@ namespace tgx
          * 4. This version use blending and opacity. If the sprite image color type has an alpha channel,
          *    then it is used for blending and multiplied by the opacity factor (even if this image does
          *    not have an alpha channel).
+         * 5. When 'scale' is an integer (1, 2, 3...), 'angle_degrees' is a multiple of 90 and the
+         *    image of the upper left corner of the sprite has integer coordinates in this
+         *    image, a faster axis-aligned path is used: each pixel whose center lies inside the
+         *    transformed sprite takes the color of the sprite pixel under that center. This differs
+         *    from the bilinear sampling used for other parameters (and by previous versions for
+         *    these ones) on about 10% of the pixels at scale 1 and up to 40% at scale 3.
          * 
          * Note: When rotated, access to  the sprite pixels colors is not linear anymore. For certain
          *       orientations, this will yield very 'irregular' access to the sprite memory locations.
@@ -869,6 +895,8 @@ namespace tgx
          * 1. the source image is resized to match this image size. Bilinear interpolation is used to
          *    improve quality.  
          * 2. The source and destination image may have different color type. Conversion is automatic.
+         * 3. When both images have the same size, the pixels are simply copied/converted (no 
+         *    interpolation) with the bulk conversion routines of Color.h.
          * 
          * Beware: This method does not check for buffer overlap between source and destination !
          *
@@ -1987,6 +2015,10 @@ namespace tgx
          * Blend with the current color background using opacity between 0.0f (fully transparent) and
          * 1.0f (fully opaque). If color_t has an alpha channel, it is used (and multiplied by opacity).
          * 
+         * Lines with wd/2 >= TGX_AALINE_SPANS_MIN_RADIUS (default 5) are drawn row by row with solid
+         * interior spans. They may have a few more border pixels than with the previous per-pixel scan
+         * (which skipped some pixels of the left border of steep lines). Thinner lines are unchanged.
+         * 
          * CREDIT: Bodmer TFT_eSPI library : https://github.com/Bodmer/TFT_eSPI
          *
          * @param   PA      first end point.
@@ -2023,6 +2055,11 @@ namespace tgx
          * Blend with the current color background using opacity between 0.0f (fully transparent) and
          * 1.0f (fully opaque). If color_t has an alpha channel, it is used (and multiplied by opacity).
          * 
+         * Wedges with max(aw,bw)/2 >= TGX_AALINE_SPANS_MIN_RADIUS (default 5) are drawn row by row with
+         * solid interior spans. They may have a few more border pixels than with the previous per-pixel
+         * scan and, when the difference between aw and bw is large compared with the length, the notch
+         * that the previous scan left at the narrow end is now filled. Smaller wedges are unchanged.
+         * 
          * CREDIT: Bodmer TFT_eSPI library : https://github.com/Bodmer/TFT_eSPI
          *
          * @param   PA      first end point
@@ -2059,6 +2096,10 @@ namespace tgx
          * Blend with the current color background using opacity between 0.0f (fully transparent) and
          * 1.0f (fully opaque). If color_t has an alpha channel, it is used (and multiplied by opacity).
          * 
+         * Spots with r >= TGX_AALINE_SPANS_MIN_RADIUS (default 5) are drawn row by row with solid
+         * interior spans and may have a few more border pixels than with the previous per-pixel scan.
+         * Smaller spots are unchanged.
+         * 
          * CREDIT: Bodmer TFT_eSPI library : https://github.com/Bodmer/TFT_eSPI
          *
          * @param   center  center point
@@ -2753,10 +2794,20 @@ private:
 
 		static void _maskRegionDown(color_t transparent_color, color_t* pdest, int dest_stride, color_t* psrc, int src_stride, int sx, int sy, float opacity);
 
+		template<bool USE_MASK, bool BACKWARD> static void _blendRow565(uint16_t* pdest, const uint16_t* psrc, int len, uint32_t op256, uint16_t transparent_color);
+
+		static void _blendFill565(uint16_t* pdest, uint16_t color, int len, uint32_t op256);
+
 
 		template<typename color_t_src, int CACHE_SIZE, bool USE_BLENDING, bool USE_MASK>
 		void _blitScaledRotated(const Image<color_t_src>& src_im, color_t_src transparent_color, fVec2 anchor_src, fVec2 anchor_dst, float scale, float angle_degrees, float opacity);
 
+		template<typename color_t_src, bool USE_BLENDING, bool USE_MASK>
+		bool _blitScaledRotatedAxisAligned(const Image<color_t_src>& src_im, color_t_src transparent_color, fVec2 anchor_src, fVec2 anchor_dst, float scale, float angle_degrees, float opacity);
+
+		template<typename color_t_src, bool USE_BLENDING, bool USE_MASK>
+		static void _blitReplicateRow(color_t* pdest, int len, const color_t_src* psrc, int step, int k, int left, color_t_src transparent_color, float opacity);
+
 
 		/***************************************
 		* DRAWING PRIMITIVES
@@ -2862,6 +2913,28 @@ private:
 		void _drawWedgeLine(float ax, float ay, float bx, float by, float aw, float bw, color_t color, float opacity);
 
 
+		/** coefficients of a wide/wedge line used to compute the pixel spans of each row */
+		struct _AALine
+			{
+			float bax, bay, aw, dr;
+			float L2, L, k;
+			float a[4], ia[4];
+			};
+
+
+		/** compute the coefficients of the line from A to A + (bax, bay) */
+		static void _aaLineInit(_AALine & S, float bax, float bay, float aw, float dr);
+
+
+		/** range [lo, hi] of the row at height py (relative to A) where the alpha of the line may be above t. Return false if empty */
+		static bool _aaLineRow(const _AALine & S, float py, float t, float xmin, float xmax, float & lo, float & hi);
+
+
+		/** draw a wide/wedge line row by row: solid spans inside and alpha computed only near the border */
+		template<bool WEDGE>
+		void _drawAALineSpans(const iBox2 & B, float ax, float ay, float bx, float by, float aw, float dr, float wd2, color_t color, float opacity);
+
+
 		/**
 		* adapted from bodmer e_tft library
 		* Calculate distance of px,py to closest part of line
@@ -2888,6 +2961,20 @@ private:
 			}
 
 
+		/** alpha value of a wide or wedge line at (pax, pay) relative to A (wd2 is only used for wide lines) */
+		template<bool WEDGE> inline TGX_INLINE float _aaLineAlpha(const _AALine & S, float pax, float pay, float wd2)
+			{
+			return (WEDGE) ? (S.aw - _wedgeLineDistance(pax, pay, S.bax, S.bay, S.dr)) : (S.aw - _wideLineDistance(pax, pay, S.bax, S.bay, wd2));
+			}
+
+
+		/** floor(a / k) for k > 0 */
+		static inline TGX_INLINE int _floorDiv(int a, int k)
+			{
+			return (a >= 0) ? (a / k) : (-((k - 1 - a) / k));
+			}
+
+
 		/** Convert to texture coordinates */
 		inline TGX_INLINE tgx::fVec2 _coord_texture(tgx::fVec2 pos, tgx::iVec2 size)
 			{
@@ -71,6 +71,13 @@ namespace tgx
 			if (len <= 0) return;
 			uint16_t* pdest = (uint16_t*)p_dest;				// recasting
 			const uint16_t col = (uint16_t)((RGB565)color);		// conversion to RGB565 does nothing but prevent compiler error when color_t is not RGB565
+#if (TGX_SIMD)
+			{ // vector kernel for most of the row (host builds)
+			const int32_t k = simdFill(pdest, col, len);
+			pdest += k; len -= k;
+			if (len <= 0) return;
+			}
+#endif
 			// ! We assume here that pdest is already aligned mod 2 (it should be) ! 
 			if (((intptr_t)pdest) & 3)
 				{
@@ -104,6 +111,12 @@ namespace tgx
 			}
 		else 
 			{ // generic code for other color types
+#if (TGX_SIMD)
+			{ // vector kernel for most of the row (host builds)
+			const int32_t k = simdFill(p_dest, color, len);
+			p_dest += k; len -= k;
+			}
+#endif
 			while (len > 0) 
 				{ 
 				*(p_dest++) = color;
@@ -143,6 +156,14 @@ namespace tgx
 	void Image<color_t>::_blendRegionUp(color_t * pdest, int dest_stride, color_t* psrc, int src_stride, int sx, int sy, float opacity)
 		{
 		const int op256 = (int)(opacity * 256);
+		if ((std::is_same <color_t, RGB565>::value) && (op256 >= 0) && (op256 <= 256)) // first test optimized away at compile time
+			{ // RGB565: row kernels (vector code on host builds)
+			for (int j = 0; j < sy; j++)
+				{
+				_blendRow565<false, false>((uint16_t*)(pdest + TGX_CAST32(j) * TGX_CAST32(dest_stride)), (const uint16_t*)(psrc + TGX_CAST32(j) * TGX_CAST32(src_stride)), sx, op256, 0);
+				}
+			return;
+			}
 		for (int j = 0; j < sy; j++)
 			{
 			color_t* pdest2 = pdest + TGX_CAST32(j) * TGX_CAST32(dest_stride);
@@ -159,6 +180,14 @@ namespace tgx
 	void Image<color_t>::_blendRegionDown(color_t* pdest, int dest_stride, color_t* psrc, int src_stride, int sx, int sy, float opacity)
 		{
 		const int op256 = (int)(opacity * 256);
+		if ((std::is_same <color_t, RGB565>::value) && (op256 >= 0) && (op256 <= 256)) // first test optimized away at compile time
+			{ // RGB565: row kernels (vector code on host builds)
+			for (int j = sy - 1; j >= 0; j--)
+				{
+				_blendRow565<false, true>((uint16_t*)(pdest + TGX_CAST32(j) * TGX_CAST32(dest_stride)), (const uint16_t*)(psrc + TGX_CAST32(j) * TGX_CAST32(src_stride)), sx, op256, 0);
+				}
+			return;
+			}
 		for (int j = sy - 1; j >= 0; j--)
 			{
 			color_t* pdest2 = pdest + TGX_CAST32(j) * TGX_CAST32(dest_stride);
@@ -175,6 +204,15 @@ namespace tgx
 	void Image<color_t>::_maskRegionUp(color_t transparent_color, color_t* pdest, int dest_stride, color_t* psrc, int src_stride, int sx, int sy, float opacity)
 		{
 		const int op256 = (int)(opacity * 256);
+		if ((std::is_same <color_t, RGB565>::value) && (op256 >= 0) && (op256 <= 256)) // first test optimized away at compile time
+			{ // RGB565: row kernels (vector code on host builds)
+			const uint16_t tr = (uint16_t)((RGB565)transparent_color);
+			for (int j = 0; j < sy; j++)
+				{
+				_blendRow565<true, false>((uint16_t*)(pdest + TGX_CAST32(j) * TGX_CAST32(dest_stride)), (const uint16_t*)(psrc + TGX_CAST32(j) * TGX_CAST32(src_stride)), sx, op256, tr);
+				}
+			return;
+			}
 		for (int j = 0; j < sy; j++)
 			{
 			color_t* pdest2 = pdest + TGX_CAST32(j) * TGX_CAST32(dest_stride);
@@ -192,6 +230,15 @@ namespace tgx
 	void Image<color_t>::_maskRegionDown(color_t transparent_color, color_t* pdest, int dest_stride, color_t* psrc, int src_stride, int sx, int sy, float opacity)
 		{
 		const int op256 = (int)(opacity * 256);
+		if ((std::is_same <color_t, RGB565>::value) && (op256 >= 0) && (op256 <= 256)) // first test optimized away at compile time
+			{ // RGB565: row kernels (vector code on host builds)
+			const uint16_t tr = (uint16_t)((RGB565)transparent_color);
+			for (int j = sy - 1; j >= 0; j--)
+				{
+				_blendRow565<true, true>((uint16_t*)(pdest + TGX_CAST32(j) * TGX_CAST32(dest_stride)), (const uint16_t*)(psrc + TGX_CAST32(j) * TGX_CAST32(src_stride)), sx, op256, tr);
+				}
+			return;
+			}
 		for (int j = sy - 1; j >= 0; j--)
 			{
 			color_t* pdest2 = pdest + TGX_CAST32(j) * TGX_CAST32(dest_stride);
@@ -205,6 +252,60 @@ namespace tgx
 		}
 
 
+	/** blend a row of RGB565 pixels */
+	template<typename color_t>
+	template<bool USE_MASK, bool BACKWARD>
+	void Image<color_t>::_blendRow565(uint16_t* pdest, const uint16_t* psrc, int len, uint32_t op256, uint16_t transparent_color)
+		{
+#if (TGX_SIMD)
+		{ // vector kernel for most of the row (host builds)
+		const int32_t k = simdBlendRow565<USE_MASK, BACKWARD>(pdest, psrc, len, op256, transparent_color);
+		if (!BACKWARD) { pdest += k; psrc += k; }
+		len -= k;
+		}
+#endif
+		if (BACKWARD)
+			{ // start from the end of the row (overlapping regions with pdest > psrc)
+			for (int i = len - 1; i >= 0; i--)
+				{
+				if ((!USE_MASK) || (psrc[i] != transparent_color)) ((RGB565*)pdest)[i].blend256(RGB565(psrc[i]), op256);
+				}
+			}
+		else
+			{
+			for (int i = 0; i < len; i++)
+				{
+				if ((!USE_MASK) || (psrc[i] != transparent_color)) ((RGB565*)pdest)[i].blend256(RGB565(psrc[i]), op256);
+				}
+			}
+		}
+
+
+	/** blend a single RGB565 color over a row of pixels */
+	template<typename color_t>
+	void Image<color_t>::_blendFill565(uint16_t* pdest, uint16_t color, int len, uint32_t op256)
+		{
+		if (len <= 0) return;
+		if (op256 >= 256)
+			{ // fully opaque: blending returns the color itself
+#if (TGX_SIMD)
+			const int32_t k = simdFill(pdest, color, len); // vector kernel (host builds)
+			pdest += k; len -= k;
+#endif
+			while (len-- > 0) { *(pdest++) = color; }
+			return;
+			}
+#if (TGX_SIMD)
+		{ // vector kernel for most of the row (host builds)
+		const int32_t k = simdBlendFill565(pdest, color, len, op256);
+		pdest += k; len -= k;
+		}
+#endif
+		const RGB565 c(color);
+		while (len-- > 0) { ((RGB565*)(pdest++))->blend256(c, op256); }
+		}
+
+
 	template<typename color_t>
 	bool Image<color_t>::_blitClip(const Image& sprite, int& dest_x, int& dest_y, int& sprite_x, int& sprite_y, int& sx, int& sy)
 		{
@@ -213,7 +314,7 @@ namespace tgx
 		if (sprite_y < 0) { dest_y -= sprite_y; sy += sprite_y; sprite_y = 0; }
 		if (dest_x < 0) { sprite_x -= dest_x;   sx += dest_x; dest_x = 0; }
 		if (dest_y < 0) { sprite_y -= dest_y;   sy += dest_y; dest_y = 0; }
-		if ((dest_x >= _lx) || (dest_y >= _ly) || (sprite_x >= sprite._lx) || (sprite_x >= sprite._ly)) return false;
+		if ((dest_x >= _lx) || (dest_y >= _ly) || (sprite_x >= sprite._lx) || (sprite_y >= sprite._ly)) return false;
 		sx -= max(0, (dest_x + sx - _lx));
 		sy -= max(0, (dest_y + sy - _ly));
 		sx -= max(0, (sprite_x + sx - sprite._lx));
@@ -311,6 +412,9 @@ namespace tgx
 		{
 		if ((!isValid()) || (!src_im.isValid())) return;
 
+		// exact kernels for multiples of 90 degrees with an integer scale and pixel aligned corners
+		if (_blitScaledRotatedAxisAligned<color_t_src, USE_BLENDING, USE_MASK>(src_im, transparent_color, anchor_src, anchor_dst, scale, angle_degrees, opacity)) return;
+
 		// number of slices to draw
 		// (we slice it to improve cache access when reading texwxture from flash)
 		const int nb_slices = (angle_degrees == 0) ? 1 : ((src_im.stride() * src_im.ly() * sizeof(color_t_src)) / CACHE_SIZE + 1);
@@ -367,11 +471,117 @@ namespace tgx
 
 
 
+	template<typename color_t>
+	template<typename color_t_src, bool USE_BLENDING, bool USE_MASK>
+	bool Image<color_t>::_blitScaledRotatedAxisAligned(const Image<color_t_src>& src_im, color_t_src transparent_color, fVec2 anchor_src, fVec2 anchor_dst, float scale, float angle_degrees, float opacity)
+		{
+		// integer scale and angle multiple of 90 degrees
+		const int k = (int)scale;
+		if ((k < 1) || ((float)k != scale)) return false;
+		float a = fmodf(angle_degrees, 360.0f);
+		if (a < 0.0f) a += 360.0f;
+		const int r = (int)(a / 90.0f);
+		if ((float)(r * 90) != a) return false;
+		// (co, so) as in the general path but exact
+		const int co = (r == 0) ? 1 : ((r == 2) ? -1 : 0);
+		const int so = (r == 1) ? 1 : ((r == 3) ? -1 : 0);
+		// image of the upper left corner of the sprite: must be on the pixel grid
+		const fVec2 P1 = scale * (fVec2(0.0f, 0.0f) - anchor_src);
+		const fVec2 Q1 = fVec2(P1.x * co - P1.y * so, P1.y * co + P1.x * so) + anchor_dst;
+		if ((floorf(Q1.x) != Q1.x) || (floorf(Q1.y) != Q1.y) || (fabsf(Q1.x) > 1000000.0f) || (fabsf(Q1.y) > 1000000.0f)) return false;
+		const int qx = (int)Q1.x;
+		const int qy = (int)Q1.y;
+		// destination box: the pixels whose center is inside the transformed sprite
+		const int ex = k * src_im.lx(), ey = k * src_im.ly();
+		const int cx = ex * co - ey * so, cy = ey * co + ex * so; // image of the opposite corner, relative to Q1
+		iBox2 B(qx + tgx::min(0, cx), qx + tgx::max(0, cx) - 1, qy + tgx::min(0, cy), qy + tgx::max(0, cy) - 1);
+		B &= imageBox();
+		if (B.isEmpty()) return true;
+		// with X = x - qx and Y = y - qy, the texel seen by the center of pixel (x, y) is
+		// (floor(X / k), floor(Y / k)) rotated back: a negative direction gives floor((-X - 1) / k).
+		const int32_t sstride = src_im.stride();
+		const int X0 = B.minX - qx;
+		for (int y = B.minY; y <= B.maxY; y++)
+			{
+			const int Y = y - qy;
+			int u, v, m, step;
+			switch (r)
+				{
+				case 0: v = _floorDiv(Y, k); m = X0; u = _floorDiv(m, k); step = 1; break;
+				case 1: u = _floorDiv(Y, k); m = -X0 - 1; v = _floorDiv(m, k); step = -sstride; break;
+				case 2: v = _floorDiv(-Y - 1, k); m = -X0 - 1; u = _floorDiv(m, k); step = -1; break;
+				default: u = _floorDiv(-Y - 1, k); m = X0; v = _floorDiv(m, k); step = sstride; break;
+				}
+			// number of pixels before moving to the next texel
+			const int rem = m - k * _floorDiv(m, k);
+			const int left = ((r == 0) || (r == 3)) ? (k - rem) : (rem + 1);
+			_blitReplicateRow<color_t_src, USE_BLENDING, USE_MASK>(_buffer + TGX_CAST32(y) * TGX_CAST32(_stride) + TGX_CAST32(B.minX), B.lx(), src_im.data() + TGX_CAST32(v) * sstride + TGX_CAST32(u), step, k, left, transparent_color, opacity);
+			}
+		return true;
+		}
+
+
+	template<typename color_t>
+	template<typename color_t_src, bool USE_BLENDING, bool USE_MASK>
+	void Image<color_t>::_blitReplicateRow(color_t* pdest, int len, const color_t_src* psrc, int step, int k, int left, color_t_src transparent_color, float opacity)
+		{
+		if ((!USE_BLENDING) && (!USE_MASK) && (k == 1) && (step == 1))
+			{ // plain copy (with color conversion)
+			convertColors(psrc, pdest, (size_t)len);
+			return;
+			}
+		while (len > 0)
+			{
+			const color_t_src col = *psrc;
+			const int n = tgx::min(left, len);
+			if (USE_MASK)
+				{ // same blending as the masked texture shader
+				if (col != transparent_color)
+					{
+					for (int i = 0; i < n; i++)
+						{
+						RGB32 c = RGB32(pdest[i]);
+						c.blend(RGB32(col), opacity);
+						pdest[i] = color_t(c);
+						}
+					}
+				}
+			else if (USE_BLENDING)
+				{ // same blending as the texture shader
+				for (int i = 0; i < n; i++)
+					{
+					color_t_src c = color_t_src(pdest[i]);
+					c.blend(col, opacity);
+					pdest[i] = color_t(c);
+					}
+				}
+			else
+				{
+				const color_t c = color_t(col);
+				for (int i = 0; i < n; i++) pdest[i] = c;
+				}
+			pdest += n;
+			len -= n;
+			psrc += step;
+			left = k;
+			}
+		}
+
+
+
 	template<typename color_t>
 	template<typename src_color_t> 
 	void Image<color_t>::copyFrom(const Image<src_color_t>& src_im)
 		{
 		if ((!isValid()) || (!src_im.isValid())) return;
+		if (src_im.dim() == dim())
+			{ // same size: no resampling, just convert the colors line by line
+			for (int j = 0; j < _ly; j++)
+				{
+				convertColors(src_im.data() + TGX_CAST32(j) * TGX_CAST32(src_im.stride()), _buffer + TGX_CAST32(j) * TGX_CAST32(_stride), (size_t)_lx);
+				}
+			return;
+			}
 		const float ilx = (float)lx();
 		const float ily = (float)ly();
 		const float tlx = (float)src_im.lx();
@@ -819,6 +1029,17 @@ namespace tgx
 		const int sx = B.lx();
 		int sy = B.ly();
 		color_t * p = _buffer + TGX_CAST32(B.minX) + TGX_CAST32(B.minY) * TGX_CAST32(_stride);
+		const int op256 = (int)(opacity * 256);
+		if ((std::is_same <color_t, RGB565>::value) && (op256 >= 0) && (op256 <= 256)) // first test optimized away at compile time
+			{ // RGB565: row kernels (vector code on host builds)
+			const uint16_t col = (uint16_t)((RGB565)color);
+			while (sy-- > 0)
+				{
+				_blendFill565((uint16_t*)p, col, sx, op256);
+				p += _stride;
+				}
+			return;
+			}
 		if (sx == _stride) 
 			{ // fast, set everything at once
 			int32_t len = TGX_CAST32(sy) * TGX_CAST32(_stride);
@@ -1512,9 +1733,6 @@ namespace tgx
 	template<typename color_t>
 	void Image<color_t>::_drawWideLine(float ax, float ay, float bx, float by, float wd, color_t color, float opacity)
 		{
-		const float LoAlphaTheshold = 64.0f / 255.0f;
-		const float HiAlphaTheshold = 1.0f - LoAlphaTheshold;
-
 		if ((abs(ax - bx) < 0.01f) && (abs(ay - by) < 0.01f)) bx += 0.01f;  // Avoid divide by zero
 
 		wd = wd / 2.0f; // wd is now end radius of line
@@ -1522,6 +1740,21 @@ namespace tgx
 		iBox2 B((int)floorf(fminf(ax, bx) - wd), (int)ceilf(fmaxf(ax, bx) + wd), (int)floorf(fminf(ay, by) - wd), (int)ceilf(fmaxf(ay, by) + wd));
 		B &= imageBox();
 		if (B.isEmpty()) return;
+
+		const bool spans = (wd >= TGX_AALINE_SPANS_MIN_RADIUS);
+		wd += 0.5f;
+		float wd2 = fmaxf(wd - 1.0f, 0.0f);
+		wd2 = wd2 * wd2;
+		if (spans)
+			{
+			_drawAALineSpans<false>(B, ax, ay, bx, by, wd, 0.0f, wd2, color, opacity);
+			return;
+			}
+
+		// thin line / small spot: the row setup of the span path costs more than it saves.
+		const float LoAlphaTheshold = 64.0f / 255.0f;
+		const float HiAlphaTheshold = 1.0f - LoAlphaTheshold;
+
 		// Find line bounding box
 		int x0 = B.minX;
 		int x1 = B.maxX;
@@ -1532,11 +1765,8 @@ namespace tgx
 		int xs = x0, yp = y1, yinc = -1;
 		if ((ax > bx && ay > by) || (ax < bx && ay < by)) { yp = y0; yinc = 1; }
 
-		float alpha = 1.0f; wd += 0.5f;
+		float alpha = 1.0f;
 		int ri = (int)wd;
-
-		float   wd2 = fmaxf(wd - 1.0f, 0.0f);
-		wd2 = wd2 * wd2;
 		float pax, pay, bax = bx - ax, bay = by - ay;
 
 		// Scan bounding box, calculate pixel intensity from distance to line
@@ -1566,9 +1796,6 @@ namespace tgx
 	template<typename color_t>
 	void Image<color_t>::_drawWedgeLine(float ax, float ay, float bx, float by, float aw, float bw, color_t color, float opacity)
 		{
-		const float LoAlphaTheshold = 64.0f / 255.0f;
-		const float HiAlphaTheshold = 1.0f - LoAlphaTheshold;
-
 		if ((abs(ax - bx) < 0.01f) && (abs(ay - by) < 0.01f)) bx += 0.01f;  // Avoid divide by zero
 
 		aw = aw / 2.0f;
@@ -1577,6 +1804,17 @@ namespace tgx
 		iBox2 B((int)floorf(fminf(ax - aw, bx - bw)), (int)ceilf(fmaxf(ax + aw, bx + bw)), (int)floorf(fminf(ay - aw, by - bw)), (int)ceilf(fmaxf(ay + aw, by + bw)));
 		B &= imageBox();
 		if (B.isEmpty()) return;
+
+		if (fmaxf(aw, bw) >= TGX_AALINE_SPANS_MIN_RADIUS)
+			{
+			_drawAALineSpans<true>(B, ax, ay, bx, by, aw + 0.5f, aw - bw, 0.0f, color, opacity);
+			return;
+			}
+
+		// thin wedge: the row setup of the span path costs more than it saves.
+		const float LoAlphaTheshold = 64.0f / 255.0f;
+		const float HiAlphaTheshold = 1.0f - LoAlphaTheshold;
+
 		// Find line bounding box
 		int x0 = B.minX;
 		int x1 = B.maxX;
@@ -1614,6 +1852,103 @@ namespace tgx
 		}
 
 
+	template<typename color_t>
+	void Image<color_t>::_aaLineInit(_AALine & S, float bax, float bay, float aw, float dr)
+		{
+		// with X = x - ax and py = y - ay, the pixels projecting inside [AB] satisfy
+		// 0 < X * bax + py * bay < L^2 and the alpha condition on the distance to [AB]
+		// gives two more linear constraints in X: each piece of a row is an interval.
+		S.bax = bax;
+		S.bay = bay;
+		S.aw = aw;
+		S.dr = dr;
+		S.L2 = bax * bax + bay * bay;
+		S.L = sqrtf(S.L2);
+		S.k = dr / S.L;
+		const float a[4] = { bax, -bax, -(S.k * bax + bay), -(S.k * bax - bay) };
+		for (int i = 0; i < 4; i++)
+			{
+			S.a[i] = a[i];
+			S.ia[i] = (a[i] != 0.0f) ? (1.0f / a[i]) : 0.0f;
+			}
+		}
+
+
+	template<typename color_t>
+	bool Image<color_t>::_aaLineRow(const _AALine & S, float py, float t, float xmin, float xmax, float & lo, float & hi)
+		{
+		const float r = S.aw - t;
+		lo = xmax; hi = xmin;
+		// part projecting inside the segment
+		const float p = py * S.bay;
+		const float b[4] = { p, S.L2 - p, S.L * r - S.k * p + py * S.bax, S.L * r - S.k * p - py * S.bax };
+		float l = xmin, h = xmax;
+		for (int i = 0; i < 4; i++)
+			{
+			if (S.a[i] > 0.0f) l = fmaxf(l, -b[i] * S.ia[i]);
+			else if (S.a[i] < 0.0f) h = fminf(h, -b[i] * S.ia[i]);
+			else if (b[i] <= 0.0f) { h = l; break; }
+			}
+		if (l < h) { lo = l; hi = h; }
+		// half disc around A
+		if ((r > 0.0f) && (r * r > py * py))
+			{
+			const float sx = sqrtf(r * r - py * py);
+			l = fmaxf(xmin, -sx); h = fminf(xmax, sx);
+			if (S.bax > 0.0f) h = fminf(h, -p * S.ia[0]); else if (S.bax < 0.0f) l = fmaxf(l, -p * S.ia[0]); else if (p > 0.0f) h = l;
+			if (l < h) { lo = fminf(lo, l); hi = fmaxf(hi, h); }
+			}
+		// half disc around B
+		const float rb = r - S.dr;
+		const float qy = py - S.bay;
+		if ((rb > 0.0f) && (rb * rb > qy * qy))
+			{
+			const float sx = sqrtf(rb * rb - qy * qy);
+			l = fmaxf(xmin, S.bax - sx); h = fminf(xmax, S.bax + sx);
+			if (S.bax > 0.0f) l = fmaxf(l, (S.L2 - p) * S.ia[0]); else if (S.bax < 0.0f) h = fminf(h, (S.L2 - p) * S.ia[0]); else if (p < S.L2) h = l;
+			if (l < h) { lo = fminf(lo, l); hi = fmaxf(hi, h); }
+			}
+		return (lo < hi);
+		}
+
+
+	template<typename color_t>
+	template<bool WEDGE>
+	void Image<color_t>::_drawAALineSpans(const iBox2 & B, float ax, float ay, float bx, float by, float aw, float dr, float wd2, color_t color, float opacity)
+		{
+		const float LoAlphaTheshold = 64.0f / 255.0f;
+		const float HiAlphaTheshold = 1.0f - LoAlphaTheshold;
+		const float margin = 1.0f / 64.0f; // so that rounding errors never discard a visible pixel
+		_AALine S;
+		_aaLineInit(S, bx - ax, by - ay, aw, dr);
+		const float xmin = B.minX - ax - 1.0f;
+		const float xmax = B.maxX - ax + 1.0f;
+		for (int y = B.minY; y <= B.maxY; y++)
+			{
+			const float pay = y - ay;
+			float lo, hi;
+			if (!_aaLineRow(S, pay, LoAlphaTheshold - margin, xmin, xmax, lo, hi)) continue;
+			int x = tgx::max(B.minX, (int)ceilf(lo + ax));
+			int xe = tgx::min(B.maxX, (int)floorf(hi + ax));
+			// the pixels with alpha above a threshold form an interval: only the borders
+			// of the row are computed and the opaque pixels in between are filled at once.
+			for (; x <= xe; x++)
+				{ // left border
+				const float alpha = _aaLineAlpha<WEDGE>(S, x - ax, pay, wd2);
+				if (alpha > HiAlphaTheshold) break;
+				if (alpha > LoAlphaTheshold) drawPixel<false>(x, y, color, alpha * opacity);
+				}
+			for (; xe > x; xe--)
+				{ // right border
+				const float alpha = _aaLineAlpha<WEDGE>(S, xe - ax, pay, wd2);
+				if (alpha > HiAlphaTheshold) break;
+				if (alpha > LoAlphaTheshold) drawPixel<false>(xe, y, color, alpha * opacity);
+				}
+			if (x <= xe) fillRect(iBox2(x, xe, y, y), color, opacity);
+			}
+		}
+
+
 
 	template<typename color_t>
 	template<typename color_alt, bool USE_BLENDING>
@@ -0,0 +1,233 @@
+/** @file ImageRLE.h */
+//
+// Copyright 2020 Arvind Singh
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+//version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _TGX_IMAGERLE_H_
+#define _TGX_IMAGERLE_H_
+
+// only C++, no plain C
+#ifdef __cplusplus
+
+
+#include "Misc.h"
+#include "Vec2.h"
+#include "Color.h"
+#include "Image.h"
+
+#include <stdint.h>
+#include <string.h>
+
+
+namespace tgx
+{
+
+
+    /** run types of an ImageRLE (bits 15-14 of the header word of a run) */
+    #define TGX_RLE_TRANSPARENT 0   // transparent pixels: no data
+    #define TGX_RLE_OPAQUE      1   // followed by one RGB565 color per pixel
+    #define TGX_RLE_SOLID       2   // followed by a single RGB565 color used for all the pixels
+    #define TGX_RLE_ALPHA       3   // followed by one RGB565 color per pixel and then one alpha byte per pixel (two per word, first pixel in the low byte)
+
+    /** maximum length of a run */
+    #define TGX_RLE_MAXRUN      16383
+
+
+    /**
+    * Run-length encoded RGB565 image with transparency.
+    *
+    * The pixels are stored as a sequence of 16-bit words. Each line is a sequence of runs
+    * covering exactly lx pixels and each run starts with a header word: the run type in bits
+    * 15-14 (TGX_RLE_TRANSPARENT, TGX_RLE_OPAQUE, TGX_RLE_SOLID or TGX_RLE_ALPHA) and the number
+    * of pixels (1 to TGX_RLE_MAXRUN) in bits 13-0, followed by the data of the run. A table
+    * gives the offset (in words) of the first run of each line so that clipped lines are
+    * skipped at no cost.
+    *
+    * Transparent runs are skipped without any per-pixel test so blitting a sprite takes a time
+    * proportional to its number of visible pixels. Solid runs store large uniform areas
+    * (backgrounds) with a single color. Colors of alpha runs are not premultiplied.
+    *
+    * The data and line table are usually created with tools/image_converter.py and stored in
+    * flash:
+    *
+    *   extern const tgx::ImageRLE sprite;                  // created by image_converter.py
+    *   ...
+    *   sprite.blit(im, { 10, 20 });                        // draw the sprite at (10,20)
+    *   sprite.blit(im, { 10, 20 }, 0.5f);                  // same, half transparent
+    *
+    * Remark: the image does not own its buffers.
+    **/
+    class ImageRLE
+    {
+
+    public:
+
+        /**
+        * Constructor. Create an invalid image.
+        **/
+        constexpr ImageRLE() : _data(nullptr), _lines(nullptr), _lx(0), _ly(0)
+            {
+            }
+
+
+        /**
+        * Constructor.
+        *
+        * - data : the runs of all the lines.
+        * - lines : the offset in data of the first run of each line (ly values).
+        * - (lx, ly) : the size of the image.
+        **/
+        constexpr ImageRLE(const uint16_t* data, const uint32_t* lines, int lx, int ly) : _data(data), _lines(lines), _lx(lx), _ly(ly)
+            {
+            }
+
+
+        /**
+        * Return true if the image is valid.
+        **/
+        bool isValid() const { return ((_data != nullptr) && (_lines != nullptr) && (_lx > 0) && (_ly > 0)); }
+
+
+        /**
+        * Image width.
+        **/
+        int lx() const { return _lx; }
+
+
+        /**
+        * Image height.
+        **/
+        int ly() const { return _ly; }
+
+
+        /**
+        * Image dimensions.
+        **/
+        iVec2 dim() const { return iVec2(_lx, _ly); }
+
+
+        /**
+        * Blit the image onto dst with its upper left corner at position upperleftpos (clipped
+        * to dst). Transparent pixels are skipped and alpha runs are blended.
+        *
+        * - opacity : global opacity multiplier in [0.0f, 1.0f].
+        **/
+        void blit(Image<RGB565>& dst, iVec2 upperleftpos, float opacity = 1.0f) const
+            {
+            if ((!isValid()) || (!dst.isValid())) return;
+            int op256 = (int)(opacity * 256);
+            if (op256 <= 0) return;
+            if (op256 > 256) op256 = 256;
+            // visible part of the image
+            const int x0 = tgx::max(0, -upperleftpos.x);
+            const int x1 = tgx::min(_lx, dst.lx() - upperleftpos.x);
+            const int y0 = tgx::max(0, -upperleftpos.y);
+            const int y1 = tgx::min(_ly, dst.ly() - upperleftpos.y);
+            if ((x0 >= x1) || (y0 >= y1)) return;
+            for (int y = y0; y < y1; y++)
+                {
+                uint16_t* d = (uint16_t*)(dst.data() + TGX_CAST32(upperleftpos.y + y) * TGX_CAST32(dst.stride()) + TGX_CAST32(upperleftpos.x + x0));
+                const uint16_t* p = _data + _lines[y];
+                int x = 0;
+                while (x < x1)
+                    {
+                    const uint16_t h = *(p++);
+                    const int type = (h >> 14);
+                    const int len = (h & TGX_RLE_MAXRUN);
+                    const uint16_t* run = p;
+                    switch (type)
+                        {
+                        case TGX_RLE_OPAQUE: p += len; break;
+                        case TGX_RLE_SOLID: p += 1; break;
+                        case TGX_RLE_ALPHA: p += len + ((len + 1) >> 1); break;
+                        default: break;
+                        }
+                    if (type != TGX_RLE_TRANSPARENT)
+                        {
+                        const int a = tgx::max(x, x0);
+                        const int b = tgx::min(x + len, x1);
+                        if (a < b) _drawRun(d + (a - x0), type, run, len, a - x, b - a, op256);
+                        }
+                    x += len;
+                    }
+                }
+            }
+
+
+    private:
+
+
+        /** draw pixels [i0, i0 + n[ of a run */
+        static void _drawRun(uint16_t* d, int type, const uint16_t* run, int len, int i0, int n, int op256)
+            {
+            switch (type)
+                {
+                case TGX_RLE_OPAQUE:
+                    {
+                    if (op256 == 256)
+                        {
+                        memcpy(d, run + i0, n * sizeof(uint16_t));
+                        }
+                    else
+                        {
+                        for (int i = 0; i < n; i++) ((RGB565*)d)[i].blend256(RGB565(run[i0 + i]), (uint32_t)op256);
+                        }
+                    return;
+                    }
+                case TGX_RLE_SOLID:
+                    {
+                    const uint16_t c = run[0];
+                    if (op256 == 256)
+                        {
+                        for (int i = 0; i < n; i++) d[i] = c;
+                        }
+                    else
+                        {
+                        for (int i = 0; i < n; i++) ((RGB565*)d)[i].blend256(RGB565(c), (uint32_t)op256);
+                        }
+                    return;
+                    }
+                case TGX_RLE_ALPHA:
+                    {
+                    const uint16_t* alpha = run + len;
+                    for (int i = 0; i < n; i++)
+                        {
+                        const int k = i0 + i;
+                        const uint32_t al = (k & 1) ? (alpha[k >> 1] >> 8) : (alpha[k >> 1] & 255);
+                        const uint32_t a256 = ((al + (al >> 7)) * op256) >> 8; // map [0,255] to [0,256] and apply the opacity
+                        ((RGB565*)d)[i].blend256(RGB565(run[k]), a256);
+                        }
+                    return;
+                    }
+                }
+            }
+
+
+        const uint16_t* _data;      // runs of all the lines
+        const uint32_t* _lines;     // offset of the first run of each line
+        int _lx, _ly;               // image size
+
+    };
+
+
+}
+
+
+#endif
+
+#endif
+
+/** end of file **/
+
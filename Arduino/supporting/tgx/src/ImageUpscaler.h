@@ -0,0 +1,312 @@
+/** @file ImageUpscaler.h */
+//
+// Copyright 2020 Arvind Singh
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+//version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _TGX_IMAGEUPSCALER_H_
+#define _TGX_IMAGEUPSCALER_H_
+
+// only C++, no plain C
+#ifdef __cplusplus
+
+
+#include "Misc.h"
+#include "Color.h"
+#include "Image.h"
+
+#include <stdint.h>
+#include <string.h>
+
+namespace tgx
+{
+
+
+    /**
+    * Conversion stage between a rendered RGB565 image and a display.
+    *
+    * The image is scaled up (nearest neighbour), optionally byte swapped (for SPI displays that
+    * expect big endian pixels) and written, a few lines at a time, into a buffer that can be sent
+    * to the screen directly (typically with a DMA transfer while the next chunk is prepared).
+    *
+    * - Scaling by an integer factor 1, 2 or 3 in both directions uses dedicated loops that read
+    *   and write two pixels per 32-bit word. Any other output size uses a generic (slower) loop.
+    * - Output lines that repeat the previous line of the same chunk are copied with memcpy().
+    * - The stride of the source image is honored. The output lines are contiguous unless a
+    *   stride is given to next().
+    *
+    * Example (replaces a hand written pixel doubling loop):
+    *
+    *   ImageUpscaler up;
+    *   up.begin(im, 2, true);                      // 2x upscale with byte swap
+    *   int y, n;
+    *   while ((n = up.next(buf, NB_LINES, y)) > 0)
+    *       {
+    *       tft.dmaWait();
+    *       tft.pushImageDMA(0, y, up.width(), n, buf, buf2);
+    *       }
+    *
+    * Remark: pixels are packed assuming a little endian CPU (ESP32, ARM, x86).
+    **/
+    class ImageUpscaler
+    {
+
+    public:
+
+        /**
+        * Constructor. begin() must be called before next().
+        **/
+        ImageUpscaler() : _src(nullptr), _slx(0), _sly(0), _sstride(0), _dlx(0), _dly(0), _scale(0), _swap(false), _y(0)
+            {
+            }
+
+
+        /**
+        * Start the conversion of an image scaled up by an integer factor (1, 2 or 3).
+        **/
+        void begin(const Image<RGB565>& im, int scale, bool swap_bytes)
+            {
+            begin(im, im.lx() * scale, im.ly() * scale, swap_bytes);
+            }
+
+
+        /**
+        * Start the conversion of an image scaled to an arbitrary size (dlx, dly). The fast
+        * loops are used when the size is exactly 1, 2 or 3 times the size of the image.
+        **/
+        void begin(const Image<RGB565>& im, int dlx, int dly, bool swap_bytes)
+            {
+            _src = (const uint16_t*)im.data();
+            _slx = im.lx();
+            _sly = im.ly();
+            _sstride = im.stride();
+            _dlx = (im.isValid()) ? dlx : 0;
+            _dly = (im.isValid()) ? dly : 0;
+            _swap = swap_bytes;
+            _scale = 0;
+            for (int k = 1; k <= 3; k++)
+                {
+                if ((_dlx == k * _slx) && (_dly == k * _sly)) _scale = k;
+                }
+            _y = 0;
+            }
+
+
+        /**
+        * Write the next chunk of at most maxlines output lines in buf and set y to the position
+        * of its first line in the output. Return the number of lines written (0 when done).
+        *
+        * Each line occupies 'stride' pixels in buf (default: width()). For the fast loops to be
+        * used, buf and stride should be such that every line starts on a 4-byte boundary.
+        **/
+        int next(uint16_t* buf, int maxlines, int& y, int stride = -1)
+            {
+            if (stride < 0) stride = _dlx;
+            y = _y;
+            const int n = min(maxlines, _dly - _y);
+            if ((n <= 0) || (_dlx <= 0)) return 0;
+            int prev_sy = -1;
+            uint16_t* d = buf;
+            for (int k = 0; k < n; k++)
+                {
+                const int sy = (_scale) ? (_y / _scale) : ((_y * _sly) / _dly);
+                if (sy == prev_sy)
+                    { // same source line as the line above
+                    memcpy(d, d - stride, _dlx * sizeof(uint16_t));
+                    }
+                else
+                    {
+                    const uint16_t* s = _src + (sy * _sstride);
+                    if (_swap) _line<true>(s, d); else _line<false>(s, d);
+                    prev_sy = sy;
+                    }
+                d += stride;
+                _y++;
+                }
+            return n;
+            }
+
+
+        /**
+        * Width of the output lines.
+        **/
+        int width() const { return _dlx; }
+
+
+        /**
+        * Number of output lines.
+        **/
+        int height() const { return _dly; }
+
+
+        /**
+        * True when all the output lines have been written.
+        **/
+        bool done() const { return (_y >= _dly); }
+
+
+    private:
+
+
+        /** swap the bytes of both pixels in a 32-bit word */
+        static TGX_INLINE inline uint32_t _swap2(uint32_t v)
+            {
+            return ((v & 0x00FF00FF) << 8) | ((v >> 8) & 0x00FF00FF);
+            }
+
+
+        /** swap the bytes of a single pixel */
+        static TGX_INLINE inline uint16_t _swap1(uint16_t v)
+            {
+            return (uint16_t)((v << 8) | (v >> 8));
+            }
+
+
+        /** convert a single line */
+        template<bool SWAP> void _line(const uint16_t* s, uint16_t* d) const
+            {
+            const bool aligned = ((((uintptr_t)d) & 3) == 0);
+            switch (aligned ? _scale : 0)
+                {
+                case 1: _line1<SWAP>(s, d); return;
+                case 2: _line2<SWAP>(s, d); return;
+                case 3: _line3<SWAP>(s, d); return;
+                default: _lineN<SWAP>(s, d); return;
+                }
+            }
+
+
+        /** 1x: two pixels per read/write when the source is also aligned */
+        template<bool SWAP> void _line1(const uint16_t* s, uint16_t* d) const
+            {
+            int n = _slx;
+            if ((((uintptr_t)s) & 3) == 0)
+                {
+                const uint32_t* s2 = (const uint32_t*)s;
+                uint32_t* d2 = (uint32_t*)d;
+                while (n > 1)
+                    {
+                    const uint32_t v = *(s2++);
+                    *(d2++) = (SWAP) ? _swap2(v) : v;
+                    n -= 2;
+                    }
+                s = (const uint16_t*)s2;
+                d = (uint16_t*)d2;
+                }
+            else
+                {
+                uint32_t* d2 = (uint32_t*)d;
+                while (n > 1)
+                    {
+                    const uint32_t v = ((uint32_t)s[0]) | (((uint32_t)s[1]) << 16);
+                    *(d2++) = (SWAP) ? _swap2(v) : v;
+                    s += 2;
+                    n -= 2;
+                    }
+                d = (uint16_t*)d2;
+                }
+            if (n) *d = (SWAP) ? _swap1(*s) : *s;
+            }
+
+
+        /** 2x: each source pixel gives one 32-bit word */
+        template<bool SWAP> void _line2(const uint16_t* s, uint16_t* d) const
+            {
+            uint32_t* d2 = (uint32_t*)d;
+            const uint16_t* const end = s + _slx;
+            while (s < end)
+                {
+                const uint32_t p = (SWAP) ? _swap1(*s) : *s;
+                *(d2++) = p | (p << 16);
+                s++;
+                }
+            }
+
+
+        /** 3x: each pair of source pixels gives three 32-bit words */
+        template<bool SWAP> void _line3(const uint16_t* s, uint16_t* d) const
+            {
+            uint32_t* d2 = (uint32_t*)d;
+            int n = _slx;
+            while (n > 1)
+                {
+                const uint32_t a = (SWAP) ? _swap1(s[0]) : s[0];
+                const uint32_t b = (SWAP) ? _swap1(s[1]) : s[1];
+                d2[0] = a | (a << 16);
+                d2[1] = a | (b << 16);
+                d2[2] = b | (b << 16);
+                d2 += 3;
+                s += 2;
+                n -= 2;
+                }
+            if (n)
+                {
+                const uint16_t a = (SWAP) ? _swap1(*s) : *s;
+                d = (uint16_t*)d2;
+                d[0] = a; d[1] = a; d[2] = a;
+                }
+            }
+
+
+        /** any size (or integer factor with unaligned output): one pixel at a time */
+        template<bool SWAP> void _lineN(const uint16_t* s, uint16_t* d) const
+            {
+            if (_scale)
+                {
+                const uint16_t* const end = s + _slx;
+                while (s < end)
+                    {
+                    const uint16_t p = (SWAP) ? _swap1(*s) : *s;
+                    for (int k = 0; k < _scale; k++) *(d++) = p;
+                    s++;
+                    }
+                return;
+                }
+            // nearest neighbour sampling: output pixel x uses source pixel floor(x * slx / dlx)
+            // (same mapping as the rows in next()), computed exactly with a quotient and a
+            // remainder so that the index never reaches slx.
+            const int q = _slx / _dlx;
+            const int r = _slx % _dlx;
+            int sx = 0, e = 0;
+            for (int x = 0; x < _dlx; x++)
+                {
+                const uint16_t p = s[sx];
+                d[x] = (SWAP) ? _swap1(p) : p;
+                sx += q;
+                e += r;
+                if (e >= _dlx) { e -= _dlx; sx++; }
+                }
+            }
+
+
+        const uint16_t* _src;   // source image buffer
+        int _slx, _sly;         // source image size
+        int _sstride;           // source image stride
+        int _dlx, _dly;         // output size
+        int _scale;             // integer scaling factor (1,2,3) or 0 for the generic loop
+        bool _swap;             // true to swap the bytes of each pixel
+        int _y;                 // next output line
+
+    };
+
+
+}
+
+
+#endif
+
+#endif
+
+/** end of file **/
+
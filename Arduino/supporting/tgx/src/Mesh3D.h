@@ -26,11 +26,14 @@
 #include "Misc.h"
 #include "Vec2.h"
 #include "Vec3.h"
+#include "Box2.h"
 #include "Box3.h"
 #include "Color.h"
 #include "Image.h"
 
 #include <stdint.h>
+#include <string.h>
+#include <new>
 
 
 namespace tgx
@@ -152,6 +155,30 @@ namespace tgx
     * 4/6   5/8  7/7
     * 8/7   9/4  5/5
     *
+    *
+    * COMPACT (QUANTIZED) FORMAT
+    *
+    * To save memory (and memory bandwidth when reading from flash), the vertice, texcoord
+    * and normal arrays may each be replaced by a quantized array. The float array pointer
+    * is then set to nullptr and the quantized one is used instead (decoded on the fly when
+    * drawing). The face array is the same in both formats.
+    *
+    * vertice_q   3 int16_t (x,y,z) per vertex, quantized inside vertice_box:
+    *             x = vertice_box.minX + (qx + 32768) * (vertice_box.maxX - vertice_box.minX) / 65535
+    *             (same for y and z). 6 bytes per vertex instead of 12. vertice_box is the
+    *             bounding box of the whole vertex array (which may be shared by chained
+    *             meshes) so it may be larger than the bounding_box of the mesh.
+    *
+    * texcoord_q  2 uint16_t (u,v) per texture coord, quantized inside texcoord_box:
+    *             u = texcoord_box.minX + qu * (texcoord_box.maxX - texcoord_box.minX) / 65535
+    *             (same for v with minY, maxY). 4 bytes per texcoord instead of 8.
+    *
+    * normal_q    1 uint16_t per normal using octahedral encoding: the high byte and the
+    *             low byte are two int8_t a and b, and (x, y) = (a/127, b/127) is the
+    *             position of the normal on the octahedron |x| + |y| + |z| = 1 folded onto
+    *             the plane z = 0 (see decodeNormalOct16()). 2 bytes per normal instead
+    *             of 12 (angular error below 1 degree).
+    *
     **/
     template<typename color_t> 
     struct Mesh3D
@@ -186,9 +213,204 @@ namespace tgx
         fBox3 bounding_box;                 // object bounding box.
         
         const char* name;                   // mesh name
+
+        // compact (quantized) arrays, see COMPACT FORMAT above. Each one is only used when
+        // the corresponding float array (vertice, texcoord, normal) is nullptr.
+        const int16_t* vertice_q;           // quantized vertex array (3 int16_t per vertex) or nullptr
+        const uint16_t* texcoord_q;         // quantized texture coord array (2 uint16_t per texcoord) or nullptr
+        const uint16_t* normal_q;           // octahedral normal array (1 uint16_t per normal) or nullptr
+        fBox3 vertice_box;                  // range of the vertices (used with vertice_q).
+        fBox2 texcoord_box;                 // range of the texture coords (used with texcoord_q).
+        };
+
+
+
+    /**
+    * Decode a normal vector stored in 16-bit octahedral format (see Mesh3D). The returned
+    * vector has unit norm.
+    **/
+    inline fVec3 decodeNormalOct16(uint16_t q)
+        {
+        float x = ((int8_t)(q >> 8)) * (1.0f / 127.0f);
+        float y = ((int8_t)(q & 255)) * (1.0f / 127.0f);
+        const float z = 1.0f - fabsf(x) - fabsf(y);
+        if (z < 0)
+            { // lower hemisphere: unfold
+            const float ox = x;
+            x = (1.0f - fabsf(y)) * ((ox >= 0) ? 1.0f : -1.0f);
+            y = (1.0f - fabsf(ox)) * ((y >= 0) ? 1.0f : -1.0f);
+            }
+        fVec3 N(x, y, z);
+        N.normalize();
+        return N;
+        }
+
+
+
+
+
+
+    /**
+    * Create a copy of a mesh where the selected arrays are copied to RAM (works on every
+    * platform).
+    *
+    * Reading a mesh from flash is much slower than reading it from RAM so copying the arrays
+    * used for every triangle (vertices, normals, faces) or the textures to fast memory is an
+    * easy way to speed up rendering when memory permits.
+    *
+    * - placement : where to copy: TGX_MEM_INTERNAL, TGX_MEM_DMA or TGX_MEM_EXTMEM (see memAlloc()).
+    * - copy_xxx  : select the arrays to copy. Arrays not copied are shared with the source mesh
+    *               (which must then remain valid). copy_vertices, copy_normals and copy_texcoords
+    *               also apply to the quantized arrays (see COMPACT FORMAT above).
+    *
+    * The meshes linked to this one (via the ->next pointer) are copied too and arrays shared
+    * between several meshes of the chain are copied only once. Everything (meshes, arrays,
+    * texture images) is allocated as a single memory block.
+    *
+    * Return a pointer to the new mesh or nullptr on error (nothing is allocated in that case).
+    * The mesh must be released with freeMesh().
+    **/
+    template<typename color_t> Mesh3D<color_t>* copyMesh(const Mesh3D<color_t>* mesh,
+                                                         int placement = TGX_MEM_INTERNAL,
+                                                         bool copy_textures = true,
+                                                         bool copy_vertices = true,
+                                                         bool copy_normals = true,
+                                                         bool copy_texcoords = true,
+                                                         bool copy_faces = true);
+
+
+    /**
+    * Delete a mesh created with copyMesh().
+    **/
+    template<typename color_t> void freeMesh(Mesh3D<color_t>* mesh);
+
+
+
+    /** layout of the memory block created by copyMesh(): list of the arrays with their offsets */
+    class _MeshBlockLayout
+        {
+        public:
+
+            _MeshBlockLayout(size_t start) : _nb(0), _size(start), _error(false) {}
+
+            /** reserve size bytes for the array src (once) and return its offset */
+            size_t add(const void* src, size_t size)
+                {
+                if ((src == nullptr) || (size == 0)) return 0;
+                for (int k = 0; k < _nb; k++)
+                    {
+                    if (_keys[k] == src)
+                        {
+                        if (size > _sizes[k]) _error = true; // same array with different sizes !
+                        return _offsets[k];
+                        }
+                    }
+                if (_nb >= MAXPTR) { _error = true; return 0; }
+                _keys[_nb] = src;
+                _sizes[_nb] = size;
+                _offsets[_nb] = _size;
+                _nb++;
+                _size += (size + 7) & (~((size_t)7)); // keep everything 8 bytes aligned
+                return _offsets[_nb - 1];
+                }
+
+            /** offset of an array already added */
+            size_t offset(const void* src) const
+                {
+                for (int k = 0; k < _nb; k++)
+                    {
+                    if (_keys[k] == src) return _offsets[k];
+                    }
+                return 0;
+                }
+
+            size_t size() const { return _size; }
+
+            bool error() const { return _error; }
+
+        private:
+
+            static const int MAXPTR = 128; // max number of arrays
+
+            int         _nb;                // number of arrays
+            size_t      _size;              // total size of the block
+            bool        _error;             // true if something went wrong
+            const void* _keys[MAXPTR];      // source arrays
+            size_t      _sizes[MAXPTR];     // their sizes
+            size_t      _offsets[MAXPTR];   // their offsets in the block
         };
 
 
+    /** size in bytes of the arrays of a mesh */
+    template<typename color_t> inline size_t _meshVerticeSize(const Mesh3D<color_t>* m) { return (m->vertice) ? m->nb_vertices * sizeof(fVec3) : m->nb_vertices * 3 * sizeof(int16_t); }
+    template<typename color_t> inline size_t _meshTexcoordSize(const Mesh3D<color_t>* m) { return (m->texcoord) ? m->nb_texcoords * sizeof(fVec2) : m->nb_texcoords * 2 * sizeof(uint16_t); }
+    template<typename color_t> inline size_t _meshNormalSize(const Mesh3D<color_t>* m) { return (m->normal) ? m->nb_normals * sizeof(fVec3) : m->nb_normals * sizeof(uint16_t); }
+
+
+    template<typename color_t> Mesh3D<color_t>* copyMesh(const Mesh3D<color_t>* mesh, int placement, bool copy_textures, bool copy_vertices, bool copy_normals, bool copy_texcoords, bool copy_faces)
+        {
+        if (mesh == nullptr) return nullptr;
+        int nb = 0;
+        for (const Mesh3D<color_t>* m = mesh; m; m = m->next) nb++;
+
+        // layout: [Mesh3D x nb][arrays and textures]
+        _MeshBlockLayout L(((nb * sizeof(Mesh3D<color_t>)) + 7) & (~((size_t)7)));
+        for (const Mesh3D<color_t>* m = mesh; m; m = m->next)
+            {
+            if (copy_vertices) L.add((m->vertice) ? (const void*)m->vertice : (const void*)m->vertice_q, _meshVerticeSize(m));
+            if (copy_texcoords) L.add((m->texcoord) ? (const void*)m->texcoord : (const void*)m->texcoord_q, _meshTexcoordSize(m));
+            if (copy_normals) L.add((m->normal) ? (const void*)m->normal : (const void*)m->normal_q, _meshNormalSize(m));
+            if (copy_faces) L.add(m->face, m->len_face * sizeof(uint16_t));
+            if ((copy_textures) && (m->texture) && (m->texture->isValid()))
+                {
+                L.add(m->texture, sizeof(Image<color_t>));
+                L.add(m->texture->data(), m->texture->lx() * m->texture->ly() * sizeof(color_t));
+                }
+            }
+        if (L.error()) return nullptr;
+
+        uint8_t* block = (uint8_t*)memAlloc(L.size(), placement);
+        if (block == nullptr) return nullptr;
+
+        // copy an array to the block (if selected) and return its new address
+        auto cp = [&](const void* src, size_t size, bool selected) -> const void*
+            {
+            if ((!selected) || (src == nullptr) || (size == 0)) return src;
+            uint8_t* dst = block + L.offset(src);
+            memcpy(dst, src, size); // (copied again when shared: harmless)
+            return dst;
+            };
+
+        Mesh3D<color_t>* res = (Mesh3D<color_t>*)block;
+        int k = 0;
+        for (const Mesh3D<color_t>* m = mesh; m; m = m->next, k++)
+            {
+            Mesh3D<color_t>* M = new (res + k) Mesh3D<color_t>(*m);
+            // (a quantized array is only used, hence copied, when the float array is missing)
+            M->vertice = (const fVec3*)cp(m->vertice, _meshVerticeSize(m), copy_vertices);
+            if (m->vertice == nullptr) M->vertice_q = (const int16_t*)cp(m->vertice_q, _meshVerticeSize(m), copy_vertices);
+            M->texcoord = (const fVec2*)cp(m->texcoord, _meshTexcoordSize(m), copy_texcoords);
+            if (m->texcoord == nullptr) M->texcoord_q = (const uint16_t*)cp(m->texcoord_q, _meshTexcoordSize(m), copy_texcoords);
+            M->normal = (const fVec3*)cp(m->normal, _meshNormalSize(m), copy_normals);
+            if (m->normal == nullptr) M->normal_q = (const uint16_t*)cp(m->normal_q, _meshNormalSize(m), copy_normals);
+            M->face = (const uint16_t*)cp(m->face, m->len_face * sizeof(uint16_t), copy_faces);
+            if ((copy_textures) && (m->texture) && (m->texture->isValid()))
+                {
+                const Image<color_t>* T = m->texture;
+                color_t* pix = (color_t*)(block + L.offset(T->data()));
+                for (int y = 0; y < T->ly(); y++) memcpy(pix + y * T->lx(), T->data() + y * T->stride(), T->lx() * sizeof(color_t));
+                M->texture = new (block + L.offset(T)) Image<color_t>(pix, T->lx(), T->ly());
+                }
+            M->next = (m->next) ? (res + k + 1) : nullptr;
+            }
+        return res;
+        }
+
+
+    template<typename color_t> void freeMesh(Mesh3D<color_t>* mesh)
+        {
+        if (mesh) memFree(mesh); // a single block, nothing to destroy
+        }
 
 
 
@@ -344,6 +566,9 @@ namespace tgx
             if (TGX_IS_EXTMEM(mesh->vertice)) map.free(mesh->vertice);
             if (TGX_IS_EXTMEM(mesh->texcoord)) map.free(mesh->texcoord);
             if (TGX_IS_EXTMEM(mesh->normal)) map.free(mesh->normal);
+            if (TGX_IS_EXTMEM(mesh->vertice_q)) map.free(mesh->vertice_q);
+            if (TGX_IS_EXTMEM(mesh->texcoord_q)) map.free(mesh->texcoord_q);
+            if (TGX_IS_EXTMEM(mesh->normal_q)) map.free(mesh->normal_q);
             if (TGX_IS_EXTMEM(mesh->face)) map.free(mesh->face);
             if (TGX_IS_EXTMEM(mesh->texture))
                 {
@@ -381,6 +606,13 @@ namespace tgx
                 if (p == nullptr) return nullptr;
                 cur_mesh->vertice = p;
                 }
+            if (TGX_IS_EXTMEM(mesh->vertice_q)) { map.freeAll(); return nullptr; }
+            if ((copy_vertices) && (mesh->nb_vertices > 0) && (TGX_IS_PROGMEM(mesh->vertice_q)))
+                {
+                int16_t* p = (int16_t*)map.malloc(mesh->vertice_q, 3 * sizeof(int16_t) * mesh->nb_vertices);
+                if (p == nullptr) return nullptr;
+                cur_mesh->vertice_q = p;
+                }
             
             if (TGX_IS_EXTMEM(mesh->texcoord)) { map.freeAll(); return nullptr; }
             if ((copy_texcoords) && (mesh->nb_texcoords > 0) && (TGX_IS_PROGMEM(mesh->texcoord)))
@@ -389,6 +621,13 @@ namespace tgx
                 if (p == nullptr) return nullptr;
                 cur_mesh->texcoord = p;
                 }
+            if (TGX_IS_EXTMEM(mesh->texcoord_q)) { map.freeAll(); return nullptr; }
+            if ((copy_texcoords) && (mesh->nb_texcoords > 0) && (TGX_IS_PROGMEM(mesh->texcoord_q)))
+                {
+                uint16_t* p = (uint16_t*)map.malloc(mesh->texcoord_q, 2 * sizeof(uint16_t) * mesh->nb_texcoords);
+                if (p == nullptr) return nullptr;
+                cur_mesh->texcoord_q = p;
+                }
             
             if (TGX_IS_EXTMEM(mesh->normal)) { map.freeAll(); return nullptr; }
             if ((copy_normals) && (mesh->nb_normals > 0) && (TGX_IS_PROGMEM(mesh->normal)))
@@ -397,6 +636,13 @@ namespace tgx
                 if (p == nullptr) return nullptr;
                 cur_mesh->normal = p;
                 }
+            if (TGX_IS_EXTMEM(mesh->normal_q)) { map.freeAll(); return nullptr; }
+            if ((copy_normals) && (mesh->nb_normals > 0) && (TGX_IS_PROGMEM(mesh->normal_q)))
+                {
+                uint16_t* p = (uint16_t*)map.malloc(mesh->normal_q, sizeof(uint16_t) * mesh->nb_normals);
+                if (p == nullptr) return nullptr;
+                cur_mesh->normal_q = p;
+                }
                     
             if (TGX_IS_EXTMEM(mesh->face)) { map.freeAll(); return nullptr; }
             if ((copy_faces) && (mesh->nb_faces > 0) && (TGX_IS_PROGMEM(mesh->face)))
@@ -0,0 +1,395 @@
+/** @file MeshFile.h */
+//
+// Copyright 2020 Arvind Singh
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+//version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _TGX_MESHFILE_H_
+#define _TGX_MESHFILE_H_
+
+// only C++, no plain C
+#ifdef __cplusplus
+
+
+#include "Misc.h"
+#include "Vec2.h"
+#include "Vec3.h"
+#include "Box2.h"
+#include "Box3.h"
+#include "Color.h"
+#include "Image.h"
+#include "Mesh3D.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <new>
+
+
+/** error codes returned by loadMeshBinary() */
+#define TGX_MESHFILE_OK             0   // no error
+#define TGX_MESHFILE_ERR_READ       -1  // could not read the file (truncated ?)
+#define TGX_MESHFILE_ERR_FORMAT     -2  // not a mesh file or corrupted file
+#define TGX_MESHFILE_ERR_VERSION    -3  // unsupported version
+#define TGX_MESHFILE_ERR_ALIGN      -4  // the buffer is not aligned on a 4 bytes boundary
+#define TGX_MESHFILE_ERR_NOMEM      -5  // out of memory
+
+/** version of the binary mesh format */
+#define TGX_MESHFILE_VERSION        1
+
+
+namespace tgx
+{
+
+
+    /**
+    * BINARY MESH FORMAT
+    *
+    * Binary counterpart of the .h files created by obj_to_h.py (select the binary output
+    * when running the script). The file contains a model made of one or more meshes chained
+    * together, all sharing the same vertex/texcoord/normal arrays, with their face arrays and
+    * their (optional) textures. Models can thus be stored on an SD card and swapped without
+    * recompiling.
+    *
+    * All values are little endian. Every array starts at an offset (from the beginning of the
+    * file) that is a multiple of 4 so the file can be used in place once it is in memory: the
+    * Mesh3D objects returned by the loaders point directly inside the file data.
+    *
+    * [MeshFileHeader]                  at offset 0
+    * [MeshFileRecord] x nb_meshes      right after the header (one for each mesh of the chain)
+    * [arrays]                          vertice, texcoord, normal, faces, textures (any order).
+    *
+    * The vertex, texcoord and normal arrays are either float arrays (fVec3, fVec2, fVec3) or
+    * quantized arrays (see the COMPACT FORMAT in Mesh3D.h) when bit 0 of 'flags' is set.
+    * Textures are stored as RGB565 pixels (lx*ly uint16_t, no padding between lines) and
+    * their dimensions must be powers of two.
+    *
+    * The loaders validate the whole file before creating the meshes: the arrays must be inside
+    * the file, every chain of the face arrays must be well formed and its indices must be
+    * inside the vertex/texcoord/normal arrays, the float normals must be unit vectors and the
+    * specular exponent must be in [0,100], so a damaged file is rejected with
+    * TGX_MESHFILE_ERR_FORMAT instead of making the renderer read out of bounds.
+    **/
+    struct MeshFileHeader
+        {
+        char     magic[4];          // "TGXM"
+        uint16_t version;           // TGX_MESHFILE_VERSION
+        uint16_t nb_meshes;         // number of meshes (= number of records)
+        uint32_t file_size;         // total size of the file in bytes
+        uint16_t nb_vertices;       // number of vertices
+        uint16_t nb_texcoords;      // number of texture coords (0 if none)
+        uint16_t nb_normals;        // number of normals (0 if none)
+        uint16_t flags;             // bit 0 : quantized arrays.
+        uint32_t vertice_offset;    // offset of the vertex array
+        uint32_t texcoord_offset;   // offset of the texcoord array (0 if none)
+        uint32_t normal_offset;     // offset of the normal array (0 if none)
+        float    vertice_box[6];    // range of the quantized vertices (minX, maxX, minY, maxY, minZ, maxZ)
+        float    texcoord_box[4];   // range of the quantized texture coords (minX, maxX, minY, maxY)
+        };
+
+
+    /**
+    * Description of a mesh inside a binary mesh file.
+    **/
+    struct MeshFileRecord
+        {
+        uint16_t nb_faces;          // number of triangles
+        uint16_t len_face;          // number of uint16_t in the face array
+        uint32_t face_offset;       // offset of the face array
+        uint32_t texture_offset;    // offset of the texture pixels (0 if none)
+        uint16_t texture_lx;        // texture width
+        uint16_t texture_ly;        // texture height
+        float    color[3];          // default color (R,G,B in [0,1])
+        float    ambiant_strength;  // ambiant light factor
+        float    diffuse_strength;  // diffuse light factor
+        float    specular_strength; // specular light factor
+        int32_t  specular_exponent; // specular exponent
+        float    bounding_box[6];   // bounding box of the mesh (minX, maxX, minY, maxY, minZ, maxZ)
+        char     name[28];          // mesh name (null terminated)
+        };
+
+
+    static_assert(sizeof(MeshFileHeader) == 72, "unexpected size for MeshFileHeader");
+    static_assert(sizeof(MeshFileRecord) == 96, "unexpected size for MeshFileRecord");
+
+
+    /**
+    * Load a binary mesh file from a stream (for example an Arduino File opened on an SD card).
+    * The STREAM type must provide a 'size_t read(uint8_t* buf, size_t len)' method.
+    *
+    * The whole file is read into a single memory block which also holds the Mesh3D objects
+    * and the texture images. When prefer_extmem is true, the block is allocated in external
+    * RAM (PSRAM on ESP32, EXTMEM on Teensy 4.1) if available and in internal RAM otherwise.
+    *
+    * Return a pointer to the first mesh of the chain or nullptr on error (then nothing is
+    * allocated and the error code TGX_MESHFILE_ERR_XXX is stored in 'error' if not nullptr).
+    * The mesh must be released with freeMeshBinary().
+    **/
+    template<typename STREAM> Mesh3D<RGB565>* loadMeshBinary(STREAM& file, bool prefer_extmem = true, int* error = nullptr);
+
+
+    /**
+    * Same as above but for a file already in memory (for example embedded in flash or read
+    * beforehand). The buffer must be aligned on a 4 bytes boundary and must remain valid as
+    * long as the mesh is used: only the (small) Mesh3D and Image objects are allocated, the
+    * arrays are used in place.
+    *
+    * The mesh must be released with freeMeshBinary() (which does not touch the buffer).
+    **/
+    Mesh3D<RGB565>* loadMeshBinary(const void* data, size_t len, bool prefer_extmem = false, int* error = nullptr);
+
+
+    /**
+    * Release a mesh created by loadMeshBinary().
+    **/
+    void freeMeshBinary(Mesh3D<RGB565>* mesh);
+
+
+
+
+
+
+
+
+
+    /*******************************************************************************************
+    *
+    * Implementation details
+    *
+    ********************************************************************************************/
+
+
+    /** size of the block holding the Mesh3D and Image objects (multiple of 8) */
+    inline size_t _meshfile_objectsSize(int nb_meshes)
+        {
+        const size_t s = nb_meshes * (sizeof(Mesh3D<RGB565>) + sizeof(Image<RGB565>));
+        return (s + 7) & (~((size_t)7));
+        }
+
+
+    /** check that an array [offset, offset + size[ is inside the file and aligned */
+    inline bool _meshfile_checkArray(uint32_t offset, uint32_t size, uint32_t file_size)
+        {
+        return ((offset & 3) == 0) && (offset >= sizeof(MeshFileHeader)) && (offset <= file_size) && (size <= file_size - offset);
+        }
+
+
+    /** check the header, return TGX_MESHFILE_OK if it looks fine */
+    inline int _meshfile_checkHeader(const MeshFileHeader& H)
+        {
+        if (memcmp(H.magic, "TGXM", 4) != 0) return TGX_MESHFILE_ERR_FORMAT;
+        if (H.version != TGX_MESHFILE_VERSION) return TGX_MESHFILE_ERR_VERSION;
+        if ((H.nb_meshes == 0) || (H.nb_vertices == 0) || (H.nb_vertices > 32767)) return TGX_MESHFILE_ERR_FORMAT;
+        if (H.file_size < sizeof(MeshFileHeader) + H.nb_meshes * sizeof(MeshFileRecord)) return TGX_MESHFILE_ERR_FORMAT;
+        return TGX_MESHFILE_OK;
+        }
+
+
+    /**
+    * Decode all the chains of a face array once and check that they stay inside the array
+    * (and end with the end tag at position len_face - 1), that every vertex, texcoord and
+    * normal index is inside its array and that the number of triangles is nb_faces.
+    **/
+    inline bool _meshfile_checkFaces(const uint16_t* face, const MeshFileRecord& R, const MeshFileHeader& H)
+        {
+        const int elem = 1 + ((H.nb_texcoords > 0) ? 1 : 0) + ((H.nb_normals > 0) ? 1 : 0);
+        const uint32_t len = R.len_face;
+        uint32_t pos = 0;
+        uint32_t nbtri = 0;
+        while (true)
+            {
+            if (pos >= len) return false;
+            const uint32_t nbt = face[pos++];
+            if (nbt == 0) break; // end tag
+            if ((nbt + 2) * elem > len - pos) return false; // chain goes past the end of the array
+            for (uint32_t k = 0; k < nbt + 2; k++)
+                {
+                const uint16_t v = face[pos++];
+                // the direction bit is only allowed after the first triangle of the chain
+                if (((k < 3) ? v : (v & 32767)) >= H.nb_vertices) return false;
+                if ((H.nb_texcoords > 0) && (face[pos++] >= H.nb_texcoords)) return false;
+                if ((H.nb_normals > 0) && (face[pos++] >= H.nb_normals)) return false;
+                }
+            nbtri += nbt;
+            }
+        return ((pos == len) && (nbtri == R.nb_faces));
+        }
+
+
+    /**
+    * Check that the float normals are unit vectors (up to rounding). The lighting code indexes
+    * its specular table with the dot products of the normals so they must not be larger.
+    **/
+    inline bool _meshfile_checkNormals(const float* n, uint32_t nb)
+        {
+        for (uint32_t i = 0; i < nb; i++, n += 3)
+            {
+            const float d = n[0] * n[0] + n[1] * n[1] + n[2] * n[2];
+            if (!(d <= 1.01f)) return false; // also rejects NaN
+            }
+        return true;
+        }
+
+
+    /** check that a texture size is usable by the shaders (non zero powers of two) */
+    inline bool _meshfile_checkTextureSize(uint32_t lx, uint32_t ly)
+        {
+        return (lx > 0) && (ly > 0) && ((lx & (lx - 1)) == 0) && ((ly & (ly - 1)) == 0);
+        }
+
+
+    /**
+    * Validate the file in 'data' and create the meshes (and textures) in 'objects'
+    * (_meshfile_objectsSize() bytes). Return TGX_MESHFILE_OK on success.
+    **/
+    inline int _meshfile_build(const uint8_t* data, void* objects)
+        {
+        const MeshFileHeader& H = *((const MeshFileHeader*)data);
+        int err = _meshfile_checkHeader(H);
+        if (err != TGX_MESHFILE_OK) return err;
+        const uint32_t fs = H.file_size;
+        const bool quant = ((H.flags & 1) != 0);
+
+        // shared arrays
+        if (!_meshfile_checkArray(H.vertice_offset, H.nb_vertices * (quant ? 6 : 12), fs)) return TGX_MESHFILE_ERR_FORMAT;
+        if ((H.nb_texcoords > 0) && (!_meshfile_checkArray(H.texcoord_offset, H.nb_texcoords * (quant ? 4 : 8), fs))) return TGX_MESHFILE_ERR_FORMAT;
+        if ((H.nb_normals > 0) && (!_meshfile_checkArray(H.normal_offset, H.nb_normals * (quant ? 2 : 12), fs))) return TGX_MESHFILE_ERR_FORMAT;
+        if ((H.nb_normals > 0) && (!quant) && (!_meshfile_checkNormals((const float*)(data + H.normal_offset), H.nb_normals))) return TGX_MESHFILE_ERR_FORMAT;
+
+        Mesh3D<RGB565>* meshes = (Mesh3D<RGB565>*)objects;
+        Image<RGB565>* images = (Image<RGB565>*)(meshes + H.nb_meshes);
+        const MeshFileRecord* rec = (const MeshFileRecord*)(data + sizeof(MeshFileHeader));
+        for (int k = 0; k < H.nb_meshes; k++)
+            {
+            const MeshFileRecord& R = rec[k];
+            if ((R.len_face == 0) || (!_meshfile_checkArray(R.face_offset, 2 * (uint32_t)R.len_face, fs))) return TGX_MESHFILE_ERR_FORMAT;
+            const uint16_t* face = (const uint16_t*)(data + R.face_offset);
+            if (!_meshfile_checkFaces(face, R, H)) return TGX_MESHFILE_ERR_FORMAT; // bad chain, index or end tag
+            if (R.texture_offset)
+                {
+                if (!_meshfile_checkTextureSize(R.texture_lx, R.texture_ly)) return TGX_MESHFILE_ERR_FORMAT;
+                if (!_meshfile_checkArray(R.texture_offset, 2 * (uint32_t)R.texture_lx * R.texture_ly, fs)) return TGX_MESHFILE_ERR_FORMAT;
+                }
+            if ((R.specular_exponent < 0) || (R.specular_exponent > 100)) return TGX_MESHFILE_ERR_FORMAT; // same range as Renderer3D::setMaterialSpecularExponent()
+            if (R.name[sizeof(R.name) - 1] != 0) return TGX_MESHFILE_ERR_FORMAT;
+            }
+
+        // everything is fine: create the objects.
+        for (int k = 0; k < H.nb_meshes; k++)
+            {
+            const MeshFileRecord& R = rec[k];
+            Mesh3D<RGB565>& M = meshes[k];
+            memset((void*)&M, 0, sizeof(M));
+            M.id = 1;
+            M.nb_vertices = H.nb_vertices;
+            M.nb_texcoords = H.nb_texcoords;
+            M.nb_normals = H.nb_normals;
+            M.nb_faces = R.nb_faces;
+            M.len_face = R.len_face;
+            const void* V = data + H.vertice_offset;
+            const void* T = (H.nb_texcoords > 0) ? data + H.texcoord_offset : nullptr;
+            const void* N = (H.nb_normals > 0) ? data + H.normal_offset : nullptr;
+            if (quant)
+                {
+                M.vertice_q = (const int16_t*)V;
+                M.texcoord_q = (const uint16_t*)T;
+                M.normal_q = (const uint16_t*)N;
+                M.vertice_box = fBox3(H.vertice_box[0], H.vertice_box[1], H.vertice_box[2], H.vertice_box[3], H.vertice_box[4], H.vertice_box[5]);
+                M.texcoord_box = fBox2(H.texcoord_box[0], H.texcoord_box[1], H.texcoord_box[2], H.texcoord_box[3]);
+                }
+            else
+                {
+                M.vertice = (const fVec3*)V;
+                M.texcoord = (const fVec2*)T;
+                M.normal = (const fVec3*)N;
+                }
+            M.face = (const uint16_t*)(data + R.face_offset);
+            if (R.texture_offset)
+                {
+                new (images + k) Image<RGB565>((void*)(data + R.texture_offset), (int)R.texture_lx, (int)R.texture_ly);
+                M.texture = images + k;
+                }
+            M.color = RGBf(R.color[0], R.color[1], R.color[2]);
+            M.ambiant_strength = R.ambiant_strength;
+            M.diffuse_strength = R.diffuse_strength;
+            M.specular_strength = R.specular_strength;
+            M.specular_exponent = R.specular_exponent;
+            M.next = (k + 1 < H.nb_meshes) ? meshes + k + 1 : nullptr;
+            M.bounding_box = fBox3(R.bounding_box[0], R.bounding_box[1], R.bounding_box[2], R.bounding_box[3], R.bounding_box[4], R.bounding_box[5]);
+            M.name = R.name;
+            }
+        return TGX_MESHFILE_OK;
+        }
+
+
+    template<typename STREAM> Mesh3D<RGB565>* loadMeshBinary(STREAM& file, bool prefer_extmem, int* error)
+        {
+        int dummy;
+        int& err = (error) ? *error : dummy;
+        MeshFileHeader H;
+        if (file.read((uint8_t*)&H, sizeof(H)) != sizeof(H)) { err = TGX_MESHFILE_ERR_READ; return nullptr; }
+        err = _meshfile_checkHeader(H);
+        if (err != TGX_MESHFILE_OK) return nullptr;
+        // single block: [Mesh3D x nb_meshes][Image x nb_meshes][file]
+        const size_t os = _meshfile_objectsSize(H.nb_meshes);
+        uint8_t* block = (uint8_t*)memAlloc(os + H.file_size, (prefer_extmem) ? TGX_MEM_EXTMEM : TGX_MEM_INTERNAL);
+        if (block == nullptr) { err = TGX_MESHFILE_ERR_NOMEM; return nullptr; }
+        uint8_t* data = block + os;
+        memcpy(data, &H, sizeof(H));
+        size_t pos = sizeof(H);
+        while (pos < H.file_size)
+            {
+            const size_t n = file.read(data + pos, H.file_size - pos);
+            if (n == 0) break;
+            pos += n;
+            }
+        if (pos != H.file_size) { memFree(block); err = TGX_MESHFILE_ERR_READ; return nullptr; }
+        err = _meshfile_build(data, block);
+        if (err != TGX_MESHFILE_OK) { memFree(block); return nullptr; }
+        return (Mesh3D<RGB565>*)block;
+        }
+
+
+    inline Mesh3D<RGB565>* loadMeshBinary(const void* data, size_t len, bool prefer_extmem, int* error)
+        {
+        int dummy;
+        int& err = (error) ? *error : dummy;
+        if ((((uintptr_t)data) & 3) != 0) { err = TGX_MESHFILE_ERR_ALIGN; return nullptr; }
+        if ((data == nullptr) || (len < sizeof(MeshFileHeader))) { err = TGX_MESHFILE_ERR_READ; return nullptr; }
+        const MeshFileHeader& H = *((const MeshFileHeader*)data);
+        err = _meshfile_checkHeader(H);
+        if (err != TGX_MESHFILE_OK) return nullptr;
+        if (len < H.file_size) { err = TGX_MESHFILE_ERR_READ; return nullptr; }
+        void* block = memAlloc(_meshfile_objectsSize(H.nb_meshes), (prefer_extmem) ? TGX_MEM_EXTMEM : TGX_MEM_INTERNAL);
+        if (block == nullptr) { err = TGX_MESHFILE_ERR_NOMEM; return nullptr; }
+        err = _meshfile_build((const uint8_t*)data, block);
+        if (err != TGX_MESHFILE_OK) { memFree(block); return nullptr; }
+        return (Mesh3D<RGB565>*)block;
+        }
+
+
+    inline void freeMeshBinary(Mesh3D<RGB565>* mesh)
+        {
+        if (mesh) memFree(mesh); // Mesh3D and Image are trivially destructible
+        }
+
+
+}
+
+
+#endif
+
+#endif
+
+/** end of file **/
+
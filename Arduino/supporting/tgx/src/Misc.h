@@ -20,6 +20,7 @@
 
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <math.h>
 
 #if defined(TEENSYDUINO) || defined(ESP32)
@@ -70,6 +71,16 @@
 #ifdef __cplusplus
 
 
+#if defined(ESP32)
+    #include "esp_heap_caps.h" // for memAlloc()
+#endif
+
+// memory placement for memAlloc()
+#define TGX_MEM_INTERNAL    0   // internal RAM
+#define TGX_MEM_DMA         1   // internal RAM usable by DMA
+#define TGX_MEM_EXTMEM      2   // external RAM if available (PSRAM / EXTMEM), internal RAM otherwise
+
+
 #if defined(ARDUINO_TEENSY41)
 
     // check existence of external ram (EXTMEM). 
@@ -170,6 +181,48 @@ namespace tgx
         return ((B <= nB) ? B : nB);
         }
 
+
+    /**
+    * Allocate memory in a given kind of RAM:
+    *
+    * - TGX_MEM_INTERNAL : internal RAM.
+    * - TGX_MEM_DMA      : internal RAM usable by DMA (same as internal RAM except on ESP32).
+    * - TGX_MEM_EXTMEM   : external RAM (PSRAM on ESP32, EXTMEM on Teensy 4.1) if available,
+    *                      otherwise internal RAM.
+    *
+    * Return nullptr if out of memory. The memory must be released with memFree().
+    **/
+    inline void* memAlloc(size_t size, int placement)
+        {
+    #if defined(ESP32)
+        if (placement == TGX_MEM_EXTMEM)
+            {
+            void* p = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+            return (p) ? p : heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+            }
+        if (placement == TGX_MEM_DMA) return heap_caps_malloc(size, MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+        return heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    #elif defined(ARDUINO_TEENSY41)
+        return (placement == TGX_MEM_EXTMEM) ? extmem_malloc(size) : malloc(size); // extmem_malloc() falls back to malloc()
+    #else
+        (void)placement;
+        return malloc(size);
+    #endif
+        }
+
+
+    /**
+    * Release memory allocated with memAlloc().
+    **/
+    inline void memFree(void* p)
+        {
+    #if defined(ARDUINO_TEENSY41)
+        extmem_free(p); // handles both internal and external RAM
+    #else
+        free(p); // also valid for heap_caps_malloc() on ESP32
+    #endif
+        }
+
 }
 
 #endif
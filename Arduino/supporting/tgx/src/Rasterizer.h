@@ -34,6 +34,58 @@ namespace tgx
 #define TGX_RASTERIZE_MULT128(X) ((X) << (TGX_RASTERIZE_SUBPIXEL_BITS -1))
 #define TGX_RASTERIZE_DIV256(X) ((X) >> (TGX_RASTERIZE_SUBPIXEL_BITS))
 
+// Largest extent (in subpixels) of the bounding box of a triangle for which the setup can be
+// done with 32-bit integers: all the products are then bounded by 2*E*(E + 2*SUBPIXEL256) < 2^31.
+#define TGX_RASTERIZE_SETUP32_EXTENT (32768 - 3*TGX_RASTERIZE_SUBPIXEL256)
+
+
+	/**
+	* Cache used by rasterizeTriangleStrip() to keep the snapped fixed-point positions
+	* of the vertices between consecutive triangles of a chain.
+	**/
+	struct RasterizerStripCache
+		{
+		iVec2 P[3];     // fixed-point positions of the vertices in each slot
+		bool valid[3];  // true if P[i] is up to date
+
+		/** invalidate all slots (call when starting a new chain) */
+		void reset() { valid[0] = false; valid[1] = false; valid[2] = false; }
+
+		/** invalidate a slot (call when the vertex in this slot is replaced) */
+		void invalidate(int slot) { valid[slot] = false; }
+		};
+
+
+	template<int LX, int LY> iVec2 rasterizerSnap(const RasterizerVec4 & V);
+
+
+	/**
+	* Sign of the (doubled) aera of the triangle P0, P1, P2 computed with integers of type INT.
+	* INT = int32_t can be used when the extent of the triangle is less than
+	* TGX_RASTERIZE_SETUP32_EXTENT and int64_t must be used otherwise.
+	**/
+	template<typename INT> TGX_INLINE inline int _rasterizeAeraSign(const iVec2 & P0, const iVec2 & P1, const iVec2 & P2)
+		{
+		const INT a = (((INT)(P2.x - P0.x)) * ((INT)(P1.y - P0.y))) - (((INT)(P2.y - P0.y)) * ((INT)(P1.x - P0.x)));
+		return (a > 0) ? 1 : ((a < 0) ? -1 : 0);
+		}
+
+
+	/**
+	* Value at the start pixel position (us, vs) of the edge function of the edge starting at P
+	* with direction (dx, dy), in pixel units, computed with integers of type INT (same remark
+	* as above).
+	**/
+	template<typename INT> TGX_INLINE inline int32_t _rasterizeEdgeStart(const int32_t us, const int32_t vs, const iVec2 & P, const int32_t dx, const int32_t dy)
+		{
+		INT dO = (((INT)(us - P.x)) * ((INT)dx)) + (((INT)(vs - P.y)) * ((INT)dy));
+		if ((dx < 0) || ((dx == 0) && (dy < 0))) dO--; // top left rule (beware, changes total aera).
+		return (dO >= 0) ? ((int32_t)TGX_RASTERIZE_DIV256(dO)) : -((int32_t)TGX_RASTERIZE_DIV256(-dO + (TGX_RASTERIZE_SUBPIXEL256 - 1)));
+		}
+
+	template<int LX, int LY, typename SHADER_FUNCTION, typename RASTERIZER_PARAMS>
+	void _rasterizeSnappedTriangle(const RasterizerVec4 & V0, const RasterizerVec4 & V1, const RasterizerVec4 & V2, const iVec2 & P0, const iVec2 & sP1, const iVec2 & sP2, const int32_t offset_x, const int32_t offset_y, const RASTERIZER_PARAMS & data, SHADER_FUNCTION shader_fun);
+
 
 	/**
 	* Main method for rasterizing a triangle onto the image for 3D graphics:
@@ -117,19 +169,68 @@ namespace tgx
 	template<int LX, int LY, typename SHADER_FUNCTION, typename RASTERIZER_PARAMS> 
 	void rasterizeTriangle(const RasterizerVec4 & V0, const RasterizerVec4 & V1, const RasterizerVec4 & V2, const int32_t offset_x, const int32_t offset_y, const RASTERIZER_PARAMS & data, SHADER_FUNCTION shader_fun)
 		{
-
 		// assuming that clipping was already perfomed and that V0, V1, V2 are in a reasonable "range" so no overflow will occur. 
+		_rasterizeSnappedTriangle<LX, LY>(V0, V1, V2, rasterizerSnap<LX, LY>(V0), rasterizerSnap<LX, LY>(V1), rasterizerSnap<LX, LY>(V2), offset_x, offset_y, data, shader_fun);
+		}
+
+
+
+	/**
+	* Rasterize a triangle which is part of a chain of triangles (see Mesh3D) where
+	* consecutive triangles share two vertices.
+	*
+	* Same as rasterizeTriangle() except that the fixed-point snapped positions of the
+	* vertices are kept in 'strip' between calls. Slot i of the cache corresponds to
+	* the i-th vertex argument so only vertices whose slot was invalidated (with
+	* strip.invalidate(i)) since the previous call are snapped again. The shared edge
+	* is thus set up from exactly the same integer coordinates as in the previous
+	* triangle.
+	*
+	* The caller must call strip.reset() when starting a new chain (or when the
+	* viewport changes) and strip.invalidate(i) each time the vertex in slot i is
+	* replaced.
+	**/
+	template<int LX, int LY, typename SHADER_FUNCTION, typename RASTERIZER_PARAMS>
+	void rasterizeTriangleStrip(RasterizerStripCache & strip, const RasterizerVec4 & V0, const RasterizerVec4 & V1, const RasterizerVec4 & V2, const int32_t offset_x, const int32_t offset_y, const RASTERIZER_PARAMS & data, SHADER_FUNCTION shader_fun)
+		{
+		if (!strip.valid[0]) { strip.P[0] = rasterizerSnap<LX, LY>(V0); strip.valid[0] = true; }
+		if (!strip.valid[1]) { strip.P[1] = rasterizerSnap<LX, LY>(V1); strip.valid[1] = true; }
+		if (!strip.valid[2]) { strip.P[2] = rasterizerSnap<LX, LY>(V2); strip.valid[2] = true; }
+		_rasterizeSnappedTriangle<LX, LY>(V0, V1, V2, strip.P[0], strip.P[1], strip.P[2], offset_x, offset_y, data, shader_fun);
+		}
+
+
+
+	/**
+	* Convert the normalized coordinates of a vertex into fixed-point viewport coordinates
+	* (with TGX_RASTERIZE_SUBPIXEL_BITS bits of subpixel precision).
+	**/
+	template<int LX, int LY>
+	TGX_INLINE inline iVec2 rasterizerSnap(const RasterizerVec4 & V)
+		{
 		const float mx = (float)(TGX_RASTERIZE_MULT128(LX));
 		const float my = (float)(TGX_RASTERIZE_MULT128(LY));
-		const iVec2  P0((int32_t)floorf(V0.x * mx), (int32_t)floorf(V0.y * my));
+		return iVec2((int32_t)floorf(V.x * mx), (int32_t)floorf(V.y * my));
+		}
 
-		const iVec2 sP1((int32_t)floorf(V1.x * mx), (int32_t)floorf(V1.y * my));
-		const iVec2 sP2((int32_t)floorf(V2.x * mx), (int32_t)floorf(V2.y * my));
 
-		int32_t xmin = (min(min(P0.x, sP1.x), sP2.x) + TGX_RASTERIZE_MULT128(LX)) / TGX_RASTERIZE_SUBPIXEL256; // use division and not bitshift  
-		int32_t xmax = (max(max(P0.x, sP1.x), sP2.x) + TGX_RASTERIZE_MULT128(LX)) / TGX_RASTERIZE_SUBPIXEL256; // in case values are negative.
-		int32_t ymin = (min(min(P0.y, sP1.y), sP2.y) + TGX_RASTERIZE_MULT128(LY)) / TGX_RASTERIZE_SUBPIXEL256; //
-		int32_t ymax = (max(max(P0.y, sP1.y), sP2.y) + TGX_RASTERIZE_MULT128(LY)) / TGX_RASTERIZE_SUBPIXEL256; //
+
+	/**
+	* Rasterize a triangle whose vertices were already snapped to the fixed-point grid.
+	* Used by rasterizeTriangle() and rasterizeTriangleStrip().
+	**/
+	template<int LX, int LY, typename SHADER_FUNCTION, typename RASTERIZER_PARAMS> 
+	void _rasterizeSnappedTriangle(const RasterizerVec4 & V0, const RasterizerVec4 & V1, const RasterizerVec4 & V2, const iVec2 & P0, const iVec2 & sP1, const iVec2 & sP2, const int32_t offset_x, const int32_t offset_y, const RASTERIZER_PARAMS & data, SHADER_FUNCTION shader_fun)
+		{
+		const int32_t pxmin = min(min(P0.x, sP1.x), sP2.x);
+		const int32_t pxmax = max(max(P0.x, sP1.x), sP2.x);
+		const int32_t pymin = min(min(P0.y, sP1.y), sP2.y);
+		const int32_t pymax = max(max(P0.y, sP1.y), sP2.y);
+
+		int32_t xmin = (pxmin + TGX_RASTERIZE_MULT128(LX)) / TGX_RASTERIZE_SUBPIXEL256; // use division and not bitshift  
+		int32_t xmax = (pxmax + TGX_RASTERIZE_MULT128(LX)) / TGX_RASTERIZE_SUBPIXEL256; // in case values are negative.
+		int32_t ymin = (pymin + TGX_RASTERIZE_MULT128(LY)) / TGX_RASTERIZE_SUBPIXEL256; //
+		int32_t ymax = (pymax + TGX_RASTERIZE_MULT128(LY)) / TGX_RASTERIZE_SUBPIXEL256; //
 
 		// intersect the sub-image with the triangle bounding box. 			
 		int32_t sx = data.im->lx();
@@ -143,7 +244,11 @@ namespace tgx
 		if (oy + sy > ymax) { sy = ymax - oy + 1; }
 		if (sy <= 0) return;
 
-		const int64_t a = (((int64_t)(sP2.x - P0.x)) * ((int64_t)(sP1.y - P0.y))) - (((int64_t)(sP2.y - P0.y)) * ((int64_t)(sP1.x - P0.x))); // aera
+		// 32-bit arithmetic is exact for the setup unless the triangle is huge (64-bit arithmetic is slow on 32-bit MCUs).
+		// (the extent is computed in unsigned arithmetic: the signed difference overflows when the vertices are far apart).
+		const bool setup32 = (((uint32_t)pxmax - (uint32_t)pxmin) < (uint32_t)TGX_RASTERIZE_SETUP32_EXTENT) && (((uint32_t)pymax - (uint32_t)pymin) < (uint32_t)TGX_RASTERIZE_SETUP32_EXTENT);
+
+		const int a = (setup32) ? _rasterizeAeraSign<int32_t>(P0, sP1, sP2) : _rasterizeAeraSign<int64_t>(P0, sP1, sP2); // sign of the aera
 
 		if (a == 0) return; // do not draw flat triangles
 
@@ -160,21 +265,15 @@ namespace tgx
 
 		const int32_t dx1 = P1.y - P0.y;
 		const int32_t dy1 = P0.x - P1.x;
-		int64_t dO1 = (((int64_t)(us - P0.x)) * ((int64_t)dx1)) + (((int64_t)(vs - P0.y)) * ((int64_t)dy1));
-		if ((dx1 < 0) || ((dx1 == 0) && (dy1 < 0))) dO1--; // top left rule (beware, changes total aera).
-		int32_t O1 = (dO1 >= 0) ? ((int32_t)TGX_RASTERIZE_DIV256(dO1)) : -((int32_t)TGX_RASTERIZE_DIV256(-dO1 + (TGX_RASTERIZE_SUBPIXEL256 - 1)));
+		int32_t O1 = (setup32) ? _rasterizeEdgeStart<int32_t>(us, vs, P0, dx1, dy1) : _rasterizeEdgeStart<int64_t>(us, vs, P0, dx1, dy1);
 
 		const int32_t dx2 = P2.y - P1.y;
 		const int32_t dy2 = P1.x - P2.x;
-		int64_t dO2 = (((int64_t)(us - P1.x)) * ((int64_t)dx2)) + (((int64_t)(vs - P1.y)) * ((int64_t)dy2));
-		if ((dx2 < 0) || ((dx2 == 0) && (dy2 < 0))) dO2--; // top left rule (beware, changes total aera).  
-		int32_t O2 = (dO2 >= 0) ? ((int32_t)TGX_RASTERIZE_DIV256(dO2)) : -((int32_t)TGX_RASTERIZE_DIV256(-dO2 + (TGX_RASTERIZE_SUBPIXEL256 - 1)));
+		int32_t O2 = (setup32) ? _rasterizeEdgeStart<int32_t>(us, vs, P1, dx2, dy2) : _rasterizeEdgeStart<int64_t>(us, vs, P1, dx2, dy2);
 
 		const int32_t dx3 = P0.y - P2.y;
 		const int32_t dy3 = P2.x - P0.x;
-		int64_t dO3 = (((int64_t)(us - P2.x)) * ((int64_t)dx3)) + (((int64_t)(vs - P2.y)) * ((int64_t)dy3));
-		if ((dx3 < 0) || ((dx3 == 0) && (dy3 < 0))) dO3--; // top left rule (beware, changes total aera).  
-		int32_t O3 = (dO3 >= 0) ? ((int32_t)TGX_RASTERIZE_DIV256(dO3)) : -((int32_t)TGX_RASTERIZE_DIV256(-dO3 + (TGX_RASTERIZE_SUBPIXEL256 - 1)));
+		int32_t O3 = (setup32) ? _rasterizeEdgeStart<int32_t>(us, vs, P2, dx3, dy3) : _rasterizeEdgeStart<int64_t>(us, vs, P2, dx3, dy3);
 
 		if (sx == 1)
 			{
@@ -245,10 +344,15 @@ namespace tgx
 		const iVec2 sP1((int32_t)floorf(V1.x * mx), (int32_t)floorf(V1.y * my));
 		const iVec2 sP2((int32_t)floorf(V2.x * mx), (int32_t)floorf(V2.y * my));
 
-		int32_t xmin = (min(min(P0.x, sP1.x), sP2.x) + TGX_RASTERIZE_MULT128(LX)) / TGX_RASTERIZE_SUBPIXEL256; // use division and not bitshift  
-		int32_t xmax = (max(max(P0.x, sP1.x), sP2.x) + TGX_RASTERIZE_MULT128(LX)) / TGX_RASTERIZE_SUBPIXEL256; // in case values are negative.
-		int32_t ymin = (min(min(P0.y, sP1.y), sP2.y) + TGX_RASTERIZE_MULT128(LY)) / TGX_RASTERIZE_SUBPIXEL256; //
-		int32_t ymax = (max(max(P0.y, sP1.y), sP2.y) + TGX_RASTERIZE_MULT128(LY)) / TGX_RASTERIZE_SUBPIXEL256; //
+		const int32_t pxmin = min(min(P0.x, sP1.x), sP2.x);
+		const int32_t pxmax = max(max(P0.x, sP1.x), sP2.x);
+		const int32_t pymin = min(min(P0.y, sP1.y), sP2.y);
+		const int32_t pymax = max(max(P0.y, sP1.y), sP2.y);
+
+		int32_t xmin = (pxmin + TGX_RASTERIZE_MULT128(LX)) / TGX_RASTERIZE_SUBPIXEL256; // use division and not bitshift  
+		int32_t xmax = (pxmax + TGX_RASTERIZE_MULT128(LX)) / TGX_RASTERIZE_SUBPIXEL256; // in case values are negative.
+		int32_t ymin = (pymin + TGX_RASTERIZE_MULT128(LY)) / TGX_RASTERIZE_SUBPIXEL256; //
+		int32_t ymax = (pymax + TGX_RASTERIZE_MULT128(LY)) / TGX_RASTERIZE_SUBPIXEL256; //
 
 		// intersect the sub-image with the triangle bounding box. 			
 		int32_t sx = data.im->lx();
@@ -262,7 +366,11 @@ namespace tgx
 		if (oy + sy > ymax) { sy = ymax - oy + 1; }
 		if (sy <= 0) return;
 
-		const int64_t a = (((int64_t)(sP2.x - P0.x)) * ((int64_t)(sP1.y - P0.y))) - (((int64_t)(sP2.y - P0.y)) * ((int64_t)(sP1.x - P0.x))); // aera
+		// 32-bit arithmetic is exact for the setup unless the triangle is huge (64-bit arithmetic is slow on 32-bit MCUs).
+		// (the extent is computed in unsigned arithmetic: the signed difference overflows when the vertices are far apart).
+		const bool setup32 = (((uint32_t)pxmax - (uint32_t)pxmin) < (uint32_t)TGX_RASTERIZE_SETUP32_EXTENT) && (((uint32_t)pymax - (uint32_t)pymin) < (uint32_t)TGX_RASTERIZE_SETUP32_EXTENT);
+
+		const int a = (setup32) ? _rasterizeAeraSign<int32_t>(P0, sP1, sP2) : _rasterizeAeraSign<int64_t>(P0, sP1, sP2); // sign of the aera
 
 		if (a == 0) return; // do not draw flat triangles
 
@@ -279,21 +387,15 @@ namespace tgx
 
 		const int32_t dx1 = P1.y - P0.y;
 		const int32_t dy1 = P0.x - P1.x;
-		int64_t dO1 = (((int64_t)(us - P0.x)) * ((int64_t)dx1)) + (((int64_t)(vs - P0.y)) * ((int64_t)dy1));
-		if ((dx1 < 0) || ((dx1 == 0) && (dy1 < 0))) dO1--; // top left rule (beware, changes total aera).
-		int32_t O1 = (dO1 >= 0) ? ((int32_t)TGX_RASTERIZE_DIV256(dO1)) : -((int32_t)TGX_RASTERIZE_DIV256(-dO1 + (TGX_RASTERIZE_SUBPIXEL256 - 1)));
+		int32_t O1 = (setup32) ? _rasterizeEdgeStart<int32_t>(us, vs, P0, dx1, dy1) : _rasterizeEdgeStart<int64_t>(us, vs, P0, dx1, dy1);
 
 		const int32_t dx2 = P2.y - P1.y;
 		const int32_t dy2 = P1.x - P2.x;
-		int64_t dO2 = (((int64_t)(us - P1.x)) * ((int64_t)dx2)) + (((int64_t)(vs - P1.y)) * ((int64_t)dy2));
-		if ((dx2 < 0) || ((dx2 == 0) && (dy2 < 0))) dO2--; // top left rule (beware, changes total aera).  
-		int32_t O2 = (dO2 >= 0) ? ((int32_t)TGX_RASTERIZE_DIV256(dO2)) : -((int32_t)TGX_RASTERIZE_DIV256(-dO2 + (TGX_RASTERIZE_SUBPIXEL256 - 1)));
+		int32_t O2 = (setup32) ? _rasterizeEdgeStart<int32_t>(us, vs, P1, dx2, dy2) : _rasterizeEdgeStart<int64_t>(us, vs, P1, dx2, dy2);
 
 		const int32_t dx3 = P0.y - P2.y;
 		const int32_t dy3 = P2.x - P0.x;
-		int64_t dO3 = (((int64_t)(us - P2.x)) * ((int64_t)dx3)) + (((int64_t)(vs - P2.y)) * ((int64_t)dy3));
-		if ((dx3 < 0) || ((dx3 == 0) && (dy3 < 0))) dO3--; // top left rule (beware, changes total aera).  
-		int32_t O3 = (dO3 >= 0) ? ((int32_t)TGX_RASTERIZE_DIV256(dO3)) : -((int32_t)TGX_RASTERIZE_DIV256(-dO3 + (TGX_RASTERIZE_SUBPIXEL256 - 1)));
+		int32_t O3 = (setup32) ? _rasterizeEdgeStart<int32_t>(us, vs, P2, dx3, dy3) : _rasterizeEdgeStart<int64_t>(us, vs, P2, dx3, dy3);
 
 		if (sx == 1)
 			{
@@ -356,6 +458,7 @@ namespace tgx
 #undef TGX_RASTERIZE_MULT256
 #undef TGX_RASTERIZE_MULT128
 #undef TGX_RASTERIZE_DIV256
+#undef TGX_RASTERIZE_SETUP32_EXTENT
 
 
 
@@ -36,8 +36,23 @@
 #include "Rasterizer.h"
 
 #include "Mesh3D.h"
+#include "TextureCache.h"
 
 
+// Meshes are drawn with a shader resolved at compile time (one instantiation of the mesh
+// drawing code per shader). The two macros below select which variants are compiled in:
+// each runtime selectable option doubles the code size of the corresponding mesh drawing
+// methods. Measured with x86-64 g++ -Os for a Renderer3D<RGB565> drawing meshes with all four
+// shaders: TGX_RENDERER3D_BILINEAR = 2 (default) costs about 12KB more than 0 or 1, and
+// TGX_RENDERER3D_BLOCKS = 1 adds about 38KB to the default (0).
+
+#ifndef TGX_RENDERER3D_BILINEAR
+#define TGX_RENDERER3D_BILINEAR (2)     // texture sampling for meshes: 0 = point sampling only, 1 = bilinear only, 2 = selected at runtime with useBilinearTexturing().
+#endif
+
+#ifndef TGX_RENDERER3D_BLOCKS
+#define TGX_RENDERER3D_BLOCKS (0)       // triangle traversal for meshes: 0 = scanline only, 1 = selected at runtime with useBlockRasterization().
+#endif
 
 
 namespace tgx
@@ -139,6 +154,46 @@ namespace tgx
             }
 
 
+        /**
+        * Set the size of the part of the viewport that is actually rendered.
+        *
+        * The normalized coordinates [-1,1]x[-1,1] are then mapped to [0,lx-1]x[0,ly-1] instead
+        * of [0,LX-1]x[0,LY-1] so the whole scene is drawn at a lower resolution in the top left
+        * corner of the viewport (using an image of size lx x ly is enough). This is done by
+        * scaling the projection matrix so the rasterizer keeps using the compile time viewport
+        * LX x LY and rendering is exactly as fast as with a template viewport of size lx x ly.
+        *
+        * The size can be changed between frames, for example to keep a constant frame rate (see
+        * DynamicResolution). The values are clamped to [1,LX] and [1,LY].
+        * default value: (LX, LY).
+        **/
+        void setViewportSize(int lx, int ly)
+            {
+            _vlx = clamp(lx, 1, LX);
+            _vly = clamp(ly, 1, LY);
+            _updateProjection();
+            }
+
+
+        /**
+        * Set the size of the part of the viewport that is actually rendered.
+        * Same as above but in vector form.
+        **/
+        void setViewportSize(const iVec2& size)
+            {
+            this->setViewportSize(size.x, size.y);
+            }
+
+
+        /**
+        * Return the size of the part of the viewport that is actually rendered.
+        **/
+        iVec2 getViewportSize() const
+            {
+            return iVec2(_vlx, _vly);
+            }
+
+
         /**
         * Set the projection matrix.
         *
@@ -156,6 +211,7 @@ namespace tgx
             {
             _projM = M;
             _projM.invertYaxis();
+            _updateProjection();
             }
 
 
@@ -185,6 +241,7 @@ namespace tgx
             static_assert(ORTHO == true, "the setOrtho() method can only be used with template parameter ORTHO = true");
             _projM.setOrtho(left, right, bottom, top, zNear, zFar);
             _projM.invertYaxis();
+            _updateProjection();
             }
 
 
@@ -203,6 +260,7 @@ namespace tgx
             static_assert(ORTHO == false, "the setFrustum() method can only be used with template parameter ORTHO = false (use projectionMatrix().setFrustum() is you really want to...)");
             _projM.setFrustum(left, right, bottom, top, zNear, zFar);
             _projM.invertYaxis();
+            _updateProjection();
             }
 
 
@@ -221,6 +279,7 @@ namespace tgx
             static_assert(ORTHO == false, "the setPerspective() method can only be used with template parameter ORTHO = false (use projectionMatrix().setPerspective() is you really want to...)");
             _projM.setPerspective(fovy, aspect, zNear, zFar);
             _projM.invertYaxis();
+            _updateProjection();
             }
 
 
@@ -275,10 +334,81 @@ namespace tgx
             }
 
 
+        /**
+        * Start an occlusion query.
+        *
+        * Until endOcclusionQuery() is called, the renderer counts the samples (pixels) of the
+        * triangles drawn that pass the depth test. The count is exact: each triangle is tested
+        * against the zbuffer as it is just before the triangle itself is drawn. The drawing is not
+        * affected but each triangle is rasterized twice while a query is active.
+        *
+        * This method is only available when ZBUFFER = true.
+        **/
+        void beginOcclusionQuery()
+            {
+            static_assert(ZBUFFER == true, "the beginOcclusionQuery() method can only be used with template parameter ZBUFFER = true");
+            _query_samples = 0;
+            _uni.query_count = &_query_samples;
+            }
+
+
+        /**
+        * End the current occlusion query and return the number of samples that passed the
+        * depth test since beginOcclusionQuery() was called (0 if no query is active).
+        *
+        * This method is only available when ZBUFFER = true.
+        **/
+        uint32_t endOcclusionQuery()
+            {
+            static_assert(ZBUFFER == true, "the endOcclusionQuery() method can only be used with template parameter ZBUFFER = true");
+            if (_uni.query_count == nullptr) return 0;
+            _uni.query_count = nullptr;
+            return _query_samples;
+            }
+
+
+        /**
+        * Test if a box may be visible with the current model matrix and zbuffer.
+        *
+        * The faces of the box that point toward the camera are rasterized against the zbuffer
+        * without writing anything (neither in the image nor in the zbuffer). Typical use: draw the
+        * large occluders first and then skip the meshes whose bounding box is hidden.
+        *
+        * - box : the box, in model coordinates (for example the bounding_box of a mesh).
+        * - nb_samples : if not nullptr, set to the number of samples of the box that pass the
+        *                depth test.
+        *
+        * Return false if the box is outside of the viewport or completely hidden. The test is
+        * conservative: a box that crosses the near plane (or would require clipping) is reported
+        * as visible and nb_samples is then set to the number of pixels of the image.
+        *
+        * This method is only available when ZBUFFER = true.
+        **/
+        bool testBoxVisible(const fBox3& box, uint32_t* nb_samples = nullptr);
+
+
+        /**
+        * Test a box against the view frustum (restricted to the part of the viewport covered by
+        * the image) with the current model matrix.
+        *
+        * - box : the box, in model coordinates.
+        *
+        * Return -1 if the box is completely outside of the frustum, 1 if it is completely inside
+        * and 0 if it may intersect its boundary. The test is done in clip space so it remains
+        * valid for boxes that extend behind the camera.
+        **/
+        int testBoxFrustum(const fBox3& box);
+
+
         /**
         * Enable/disable the use of bilinear point sampling when using texture mapping.  
         * Enabling it increase the quality of the rendering but is much more compute expensive. 
         * default value = false. 
+        *
+        * For meshes, the choice is only available at runtime when TGX_RENDERER3D_BILINEAR = 2
+        * (default). This compiles both variants of every textured mesh shader. Set it to 0 or 1 to
+        * select point sampling or bilinear sampling at compile time and save the code of the other
+        * variant (about 12KB per Renderer3D instantiation).
         **/
         void useBilinearTexturing(bool enable)
             {
@@ -286,6 +416,59 @@ namespace tgx
             }
 
 
+        /**
+        * Enable/disable block rasterization.
+        *
+        * When enabled, triangles are traversed by 8x8 blocks: blocks outside of the triangle are
+        * skipped, blocks inside are drawn without any coverage test and only the blocks crossed
+        * by an edge are tested pixel by pixel. This speeds up the rendering of large triangles
+        * (low poly models, large faces close to the camera) and gives exactly the same result
+        * as the default scanline traversal.
+        * default value = false.
+        *
+        * For meshes, this option is ignored unless TGX_RENDERER3D_BLOCKS is set to 1 before
+        * including tgx.h (the default, 0, does not compile the block traversal of the mesh
+        * shaders in order to save flash).
+        **/
+        void useBlockRasterization(bool enable)
+            {
+            _uni.use_block_rasterization = enable;
+            }
+
+
+        /**
+        * Enable/disable fixed point lighting for meshes drawn with Gouraud shading.
+        *
+        * When enabled, the light and halfway vectors are moved to the model space once per
+        * mesh (so normals are not transformed anymore) and the lighting of each vertex is
+        * computed with integer arithmetic (octahedral normals are decoded without any float
+        * operation). This is faster on MCUs with a slow FPU (ESP32) and the colors obtained 
+        * are within one RGB565 step of those computed with the float path.
+        * default value = false.
+        *
+        * Only used by drawMesh() and only valid for model matrices without non-uniform scaling.
+        **/
+        void useFixedPointLighting(bool enable)
+            {
+            _fixedLighting = enable;
+            }
+
+
+
+        /**
+        * Set the cache used to obtain the textures of the meshes (or nullptr to use the
+        * textures directly). See TextureCache.h.
+        *
+        * When set, each textured mesh drawn with drawMesh() asks the cache for its texture so
+        * that the textures registered with the cache are loaded in (fast) memory on demand.
+        * default value = nullptr.
+        **/
+        void setTextureCache(TextureCache<color_t>* cache)
+            {
+            _texcache = cache;
+            }
+
+
         /*****************************************************************************************
         ******************************************************************************************
         *
@@ -314,6 +497,7 @@ namespace tgx
             _viewM = M;
             // recompute
             _r_modelViewM = _viewM * _modelM;
+            _r_modelViewProjM = _r_projM * _r_modelViewM;
             _r_inorm = 1.0f / _r_modelViewM.mult0(fVec3{ 0,0,1 }).norm();
             _r_light = _viewM.mult0(_light);
             _r_light = -_r_light;
@@ -457,6 +641,7 @@ namespace tgx
             _modelM = M;
             // recompute
             _r_modelViewM = _viewM * _modelM;
+            _r_modelViewProjM = _r_projM * _r_modelViewM;
             _r_inorm = 1.0f / _r_modelViewM.mult0(fVec3{ 0,0,1 }).norm();
             _r_light_inorm = _r_light * _r_inorm;
             _r_H_inorm = _r_H * _r_inorm;
@@ -1216,10 +1401,18 @@ namespace tgx
         ************************************************************/
 
 
-        /** Method called by drawMesh() which does the actual drawing. */
+        /** Method called by drawMesh(): select the shader once for the whole mesh. */
         template<int RASTER_TYPE> void _drawMesh(const Mesh3D<color_t>* mesh);
 
 
+        /** Method called by _drawMesh() once the texture sampling mode is known. */
+        template<int RASTER_TYPE, bool TEXTURE_BILINEAR> void _drawMeshTraversal(const Mesh3D<color_t>* mesh);
+
+
+        /** Method called by _drawMesh() which does the actual drawing with a given shader. */
+        template<int RASTER_TYPE, typename SHADER_FUNCTION> void _drawMesh(const Mesh3D<color_t>* mesh, SHADER_FUNCTION shader_fun);
+
+
 
         /** draw a single triangle */
         void _drawTriangle(const int RASTER_TYPE,
@@ -1245,20 +1438,20 @@ namespace tgx
             // test if clipping is needed
             static const float clipboundXY = (2048 / ((LX > LY) ? LX : LY));
 
-            (*((fVec4*)&PC0)) = _projM * Q0;
+            (*((fVec4*)&PC0)) = _r_projM * Q0;
             if (ORTHO) { PC0.w = 2.0f - PC0.z; } else { PC0.zdivide(); }
             bool needclip = (Q0.z >= 0)
                           | (PC0.x < -clipboundXY) | (PC0.x > clipboundXY)
                           | (PC0.y < -clipboundXY) | (PC0.y > clipboundXY)
                           | (PC0.z < -1) | (PC0.z > 1);
-            (*((fVec4*)&PC1)) = _projM * Q1;
+            (*((fVec4*)&PC1)) = _r_projM * Q1;
             if (ORTHO) { PC1.w = 2.0f - PC1.z; } else { PC1.zdivide(); }
             needclip |= (Q1.z >= 0)
                      | (PC1.x < -clipboundXY) | (PC1.x > clipboundXY)
                      | (PC1.y < -clipboundXY) | (PC1.y > clipboundXY)
                      | (PC1.z < -1) | (PC1.z > 1);
 
-            (*((fVec4*)&PC2)) = _projM * Q2;
+            (*((fVec4*)&PC2)) = _r_projM * Q2;
             if (ORTHO) { PC2.w = 2.0f - PC2.z; } else { PC2.zdivide(); }
             needclip |= (Q2.z >= 0)
                      | (PC2.x < -clipboundXY) | (PC2.x > clipboundXY)
@@ -1313,6 +1506,7 @@ namespace tgx
                 }
 
             // go rasterize !          
+            if ((ZBUFFER) && (_uni.query_count)) rasterizeTriangle<LX, LY>(PC0, PC1, PC2, _ox, _oy, _uni, shader_DepthQuery<color_t>);
             rasterizeTriangle<LX, LY>(PC0, PC1, PC2, _ox, _oy, _uni, shader_select<ZBUFFER, ORTHO, color_t>);
 
             return;
@@ -1346,21 +1540,21 @@ namespace tgx
             // test if clipping is needed
             static const float clipboundXY = (2048 / ((LX > LY) ? LX : LY));
 
-            (*((fVec4*)&PC0)) = _projM * Q0;
+            (*((fVec4*)&PC0)) = _r_projM * Q0;
             if (ORTHO) { PC0.w = 2.0f - PC0.z; } else { PC0.zdivide(); }
             bool needclip  = (Q0.z >= 0)
                            | (PC0.x < -clipboundXY) | (PC0.x > clipboundXY)
                            | (PC0.y < -clipboundXY) | (PC0.y > clipboundXY)
                            | (PC0.z < -1) | (PC0.z > 1);
 
-            (*((fVec4*)&PC1)) = _projM * Q1;
+            (*((fVec4*)&PC1)) = _r_projM * Q1;
             if (ORTHO) { PC1.w = 2.0f - PC1.z; } else { PC1.zdivide(); }
             needclip |= (Q1.z >= 0)
                      | (PC1.x < -clipboundXY) | (PC1.x > clipboundXY)
                      | (PC1.y < -clipboundXY) | (PC1.y > clipboundXY)
                      | (PC1.z < -1) | (PC1.z > 1);
 
-            (*((fVec4*)&PC2)) = _projM * Q2;
+            (*((fVec4*)&PC2)) = _r_projM * Q2;
             if (ORTHO) { PC2.w = 2.0f - PC2.z; } else { PC2.zdivide(); }
             needclip |= (Q2.z >= 0)
                      | (PC2.x < -clipboundXY) | (PC2.x > clipboundXY)
@@ -1368,7 +1562,7 @@ namespace tgx
                      | (PC2.z < -1) | (PC2.z > 1);
 
 
-            (*((fVec4*)&PC3)) = _projM * Q3;
+            (*((fVec4*)&PC3)) = _r_projM * Q3;
             if (ORTHO) { PC3.w = 2.0f - PC3.z; } else { PC3.zdivide(); }
             needclip |= (Q3.z >= 0)
                      | (PC3.x < -clipboundXY) | (PC3.x > clipboundXY)
@@ -1426,7 +1620,9 @@ namespace tgx
                 }
 
             // go rasterize !
+            if ((ZBUFFER) && (_uni.query_count)) rasterizeTriangle<LX, LY>(PC0, PC1, PC2, _ox, _oy, _uni, shader_DepthQuery<color_t>);
             rasterizeTriangle<LX, LY>(PC0, PC1, PC2, _ox, _oy, _uni, shader_select<ZBUFFER, ORTHO, color_t>);
+            if ((ZBUFFER) && (_uni.query_count)) rasterizeTriangle<LX, LY>(PC0, PC2, PC3, _ox, _oy, _uni, shader_DepthQuery<color_t>);
             rasterizeTriangle<LX, LY>(PC0, PC2, PC3, _ox, _oy, _uni, shader_select<ZBUFFER, ORTHO, color_t>);
             
             return;
@@ -1457,6 +1653,81 @@ namespace tgx
             }
 
 
+        /** compute _r_projM from _projM and the size of the rendered part of the viewport. */
+        void _updateProjection()
+            {
+            _r_projM = _projM;
+            if ((_vlx != LX) || (_vly != LY))
+                {
+                // map [-1,1] to [-1, 2*vlx/LX - 1] before the z-divide: x' = sx*x + (sx - 1)*w
+                const float sx = ((float)_vlx) / LX;
+                const float sy = ((float)_vly) / LY;
+                for (int k = 0; k < 4; k++)
+                    {
+                    _r_projM.M[4 * k] = sx * _projM.M[4 * k] + (sx - 1.0f) * _projM.M[4 * k + 3];
+                    _r_projM.M[4 * k + 1] = sy * _projM.M[4 * k + 1] + (sy - 1.0f) * _projM.M[4 * k + 3];
+                    }
+                }
+            _r_modelViewProjM = _r_projM * _r_modelViewM;
+            }
+
+
+        /** matrix that maps the raw (int16) quantized positions of a mesh to view space. */
+        fMat4 _quantizedModelView(const fBox3& B) const
+            {
+            const fVec3 S((B.maxX - B.minX) / 65535.0f, (B.maxY - B.minY) / 65535.0f, (B.maxZ - B.minZ) / 65535.0f);
+            fMat4 D;
+            D.setScale(S);
+            D.multTranslate(B.minX + 32768.0f * S.x, B.minY + 32768.0f * S.y, B.minZ + 32768.0f * S.z);
+            return _r_modelViewM * D;
+            }
+
+
+        /**
+        * Transform a mesh vertex directly to clip space with mvpM (= projection * posM) and do the
+        * z-divide. Only the z coordinate of the view space position is computed (for the clipping test),
+        * from posM so that it is correct for any projection matrix.
+        **/
+        static TGX_INLINE inline void _projectVertexFused(RasterizerVec4& V, float& viewz, const fMat4& mvpM, const fMat4& posM, const fVec3& v)
+            {
+            *((fVec4*)&V) = mvpM.mult1(v);
+            viewz = posM.M[2] * v.x + posM.M[6] * v.y + posM.M[10] * v.z + posM.M[14];
+            if (ORTHO)
+                {
+                V.w = 2.0f - V.z;
+                }
+            else
+                {
+                V.zdivide();
+                }
+            }
+
+
+        /** vertex i of a mesh: from the float array or from the raw quantized array (to be transformed with _quantizedModelView()) */
+        static TGX_INLINE inline fVec3 _meshVertex(const fVec3* tab_vert, const int16_t* tab_vert_q, int i)
+            {
+            if (tab_vert) return tab_vert[i];
+            const int16_t* q = tab_vert_q + 3 * i;
+            return fVec3((float)q[0], (float)q[1], (float)q[2]);
+            }
+
+
+        /** normal i of a mesh: from the float array or decoded from the octahedral array */
+        static TGX_INLINE inline fVec3 _meshNormal(const fVec3* tab_norm, const uint16_t* tab_norm_q, int i)
+            {
+            return (tab_norm) ? tab_norm[i] : decodeNormalOct16(tab_norm_q[i]);
+            }
+
+
+        /** texture coord i of a mesh: from the float array or dequantized inside the box T */
+        static TGX_INLINE inline fVec2 _meshTexcoord(const fVec2* tab_tex, const uint16_t* tab_tex_q, const fBox2& T, int i)
+            {
+            if (tab_tex) return tab_tex[i];
+            const uint16_t* q = tab_tex_q + 2 * i;
+            return fVec2(T.minX + q[0] * ((T.maxX - T.minX) / 65535.0f), T.minY + q[1] * ((T.maxY - T.minY) / 65535.0f));
+            }
+
+
         /* test if a box is outside the image and should be discarded. */
         bool _discard(const fBox3 & bb, const fMat4& M)
             {
@@ -1530,6 +1801,8 @@ namespace tgx
         int _currentpow;                    // exponent for the currently computed table (<0 if table not yet computed)
         float _powfact;                     // used to compute exponent
         float _fastpowtab[_POWTABSIZE];     // the precomputed power table.
+        int32_t _ipowfact;                  // _powfact in Q8 (fixed point lighting)
+        int32_t _ifastpowtab[_POWTABSIZE];  // the precomputed power table in Q15 (fixed point lighting)
 
         /** Pre-compute the power table for computing specular light component (if needed). */
         void _precomputeSpecularTable(int exponent)
@@ -1555,6 +1828,8 @@ namespace tgx
                     _fastpowtab[k] = 0.0f;
                     }
                 }
+            _ipowfact = (int32_t)(_powfact * 256.0f + 0.5f);
+            for (int k = 0; k < _POWTABSIZE; k++) _ifastpowtab[k] = (int32_t)(_fastpowtab[k] * 32768.0f + 0.5f);
             }
 
         /** compute pow(x, exponent) using linear interpolation from the pre-computed table */
@@ -1590,6 +1865,108 @@ namespace tgx
             }
 
 
+        /** per mesh constants of the fixed point lighting path */
+        struct _FixedLighting
+            {
+            fVec3   L;                  // light vector in model space (multiplied by inorm)
+            fVec3   H;                  // halfway vector in model space (multiplied by inorm)
+            int32_t iL[3];              // same as L in Q14
+            int32_t iH[3];              // same as H in Q14
+            int32_t A[3], D[3], S[3];   // ambient, diffuse and specular colors in Q12 (multiplied by the object color if not texturing)
+            };
+
+
+        /** compute the constants of the fixed point lighting path for the current model (dot(M^T.L, N) = dot(L, M.N)) */
+        template<bool TEXTURE> void _setupFixedLighting(_FixedLighting& FL) const
+            {
+            const float* M = _r_modelViewM.M;
+            FL.L = fVec3(M[0] * _r_light_inorm.x + M[1] * _r_light_inorm.y + M[2] * _r_light_inorm.z,
+                         M[4] * _r_light_inorm.x + M[5] * _r_light_inorm.y + M[6] * _r_light_inorm.z,
+                         M[8] * _r_light_inorm.x + M[9] * _r_light_inorm.y + M[10] * _r_light_inorm.z);
+            FL.H = fVec3(M[0] * _r_H_inorm.x + M[1] * _r_H_inorm.y + M[2] * _r_H_inorm.z,
+                         M[4] * _r_H_inorm.x + M[5] * _r_H_inorm.y + M[6] * _r_H_inorm.z,
+                         M[8] * _r_H_inorm.x + M[9] * _r_H_inorm.y + M[10] * _r_H_inorm.z);
+            const float tL[3] = { FL.L.x, FL.L.y, FL.L.z };
+            const float tH[3] = { FL.H.x, FL.H.y, FL.H.z };
+            RGBf A = _r_ambiantColor, D = _r_diffuseColor, S = _r_specularColor;
+            if (!(TEXTURE)) { A *= _r_objectColor; D *= _r_objectColor; S *= _r_objectColor; }
+            const float tA[3] = { A.R, A.G, A.B };
+            const float tD[3] = { D.R, D.G, D.B };
+            const float tS[3] = { S.R, S.G, S.B };
+            for (int k = 0; k < 3; k++)
+                {
+                FL.iL[k] = (int32_t)roundf(clamp(tL[k], -1.5f, 1.5f) * 16384.0f);
+                FL.iH[k] = (int32_t)roundf(clamp(tH[k], -1.5f, 1.5f) * 16384.0f);
+                FL.A[k] = (int32_t)roundf(clamp(tA[k], 0.0f, 7.0f) * 4096.0f);
+                FL.D[k] = (int32_t)roundf(clamp(tD[k], 0.0f, 7.0f) * 4096.0f);
+                FL.S[k] = (int32_t)roundf(clamp(tS[k], 0.0f, 7.0f) * 4096.0f);
+                }
+            }
+
+
+        /** 2^19/sqrt(len2) for len2 in [256*20, 256*66] (norm of the octahedral normals before normalization) */
+        static TGX_INLINE inline int32_t _rsqrtFixed(int32_t len2)
+            {
+            static const uint16_t tab[47] = { 7327, 7151, 6986, 6833, 6689, 6554, 6426, 6306, 6193, 6085, 5983, 5885, 5793, 5704, 5620, 5539,
+                                              5461, 5387, 5316, 5247, 5181, 5118, 5056, 4997, 4940, 4885, 4831, 4780, 4730, 4681, 4634, 4588,
+                                              4544, 4501, 4459, 4418, 4379, 4340, 4303, 4266, 4230, 4196, 4162, 4128, 4096, 4064, 4033 };
+            const int32_t i = (len2 >> 8) - 20;
+            return tab[i] - ((((int32_t)tab[i] - (int32_t)tab[i + 1]) * (len2 & 255)) >> 8);
+            }
+
+
+        /** dot products (in Q14) of normal i of a mesh with the light and halfway vectors of the fixed point lighting path */
+        static TGX_INLINE inline void _meshNormalDotsFixed(const _FixedLighting& FL, const fVec3* tab_norm, const uint16_t* tab_norm_q, int i, int32_t& dl, int32_t& dh)
+            {
+            if (tab_norm)
+                {
+                const fVec3 & N = tab_norm[i];
+                dl = (int32_t)(dotProduct(N, FL.L) * 16384.0f);
+                dh = (int32_t)(dotProduct(N, FL.H) * 16384.0f);
+                return;
+                }
+            // same as decodeNormalOct16() but with integers and without normalization: |x| + |y| + |z| = 127
+            const uint16_t q = tab_norm_q[i];
+            int32_t x = (int8_t)(q >> 8);
+            int32_t y = (int8_t)(q & 255);
+            const int32_t ax = (x < 0) ? -x : x;
+            const int32_t ay = (y < 0) ? -y : y;
+            const int32_t z = 127 - ax - ay;
+            if (z < 0)
+                { // lower hemisphere: unfold
+                x = (x >= 0) ? (127 - ay) : (ay - 127);
+                y = (y >= 0) ? (127 - ax) : (ax - 127);
+                }
+            const int32_t r = _rsqrtFixed(x * x + y * y + z * z);
+            dl = (((x * FL.iL[0] + y * FL.iL[1] + z * FL.iL[2]) >> 7) * r) >> 12;
+            dh = (((x * FL.iH[0] + y * FL.iH[1] + z * FL.iH[2]) >> 7) * r) >> 12;
+            }
+
+
+        /** same as _powSpecular() with x in Q14 and the result in Q15 */
+        TGX_INLINE int32_t _powSpecularFixed(int32_t x) const
+            {
+            const int32_t indf = ((16384 - x) * _ipowfact) >> 14; // Q8
+            const int32_t indi = indf >> 8;
+            return (indi >= (_POWTABSIZE - 1)) ? 0 : (_ifastpowtab[indi] + (((_ifastpowtab[indi + 1] - _ifastpowtab[indi]) * (indf & 255)) >> 8));
+            }
+
+
+        /** same as _phong() but with fixed point arithmetic: dl and dh are the dot products in Q14 */
+        TGX_INLINE RGBf _phongFixed(const _FixedLighting& FL, int32_t dl, int32_t dh) const
+            {
+            dl = clamp<int32_t>(dl, 0, 16384);
+            dh = clamp<int32_t>(dh, 0, 16384);
+            const int32_t sp = _powSpecularFixed(dh);
+            int32_t c[3];
+            for (int k = 0; k < 3; k++)
+                {
+                c[k] = clamp<int32_t>(FL.A[k] + ((FL.D[k] * dl) >> 14) + ((FL.S[k] * sp) >> 15), 0, 4096);
+                }
+            return RGBf(c[0] * (1.0f / 4096.0f), c[1] * (1.0f / 4096.0f), c[2] * (1.0f / 4096.0f));
+            }
+
+
         /***********************************************************
         * MEMBER VARIABLES
         ************************************************************/
@@ -1600,12 +1977,21 @@ namespace tgx
 
         fMat4   _projM;             // projection matrix
 
+        int     _vlx, _vly;         // size of the rendered part of the viewport (at most LX x LY)
+        fMat4   _r_projM;           // projection matrix scaled to the rendered part of the viewport
+
         int     _zbuffer_len;       // size of the zbuffer
+
+        TextureCache<color_t>* _texcache;   // texture cache used by drawMesh() (or nullptr)
         
         RasterizerParams<color_t, color_t>  _uni; // rasterizer param (contain the image pointer and the zbuffer pointer).
 
         float _culling_dir;         // culling direction postive/negative or 0 to disable back face culling.
 
+        bool _fixedLighting;        // true to use the fixed point lighting path for meshes.
+
+        uint32_t _query_samples;    // samples counted by the current occlusion query (when _uni.query_count != nullptr).
+
 
         // *** scene parameters ***
 
@@ -1630,6 +2016,7 @@ namespace tgx
 
         // *** pre-computed values ***
         fMat4 _r_modelViewM;        // model-view matrix
+        fMat4 _r_modelViewProjM;    // projection matrix times model-view matrix (model space to clip space)
         float _r_inorm;             // inverse of the norm of a unit vector after view transform
         fVec3 _r_light;             // light vector in view space (inverted and normalized)
         fVec3 _r_light_inorm;       // same as above but alreadsy muliplied by inorm
@@ -1678,7 +2065,7 @@ namespace tgx
 
 
         template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO>
-        Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO>::Renderer3D() : _currentpow(-1), _ox(0), _oy(0), _zbuffer_len(0), _uni(), _culling_dir(1)
+        Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO>::Renderer3D() : _currentpow(-1), _ox(0), _oy(0), _vlx(LX), _vly(LY), _zbuffer_len(0), _texcache(nullptr), _uni(), _culling_dir(1), _fixedLighting(false), _query_samples(0)
             {
             _uni.im = nullptr;
             _uni.tex = nullptr; 
@@ -1686,6 +2073,8 @@ namespace tgx
             _uni.zbuf = 0; 
             _uni.facecolor = RGBf(1.0, 1.0, 1.0);
             _uni.use_bilinear_texturing = false;
+            _uni.use_block_rasterization = false;
+            _uni.query_count = nullptr;
 
             // let's set some default values
             fMat4 M;
@@ -1717,7 +2106,7 @@ namespace tgx
 
             while (mesh)
                 {
-                if (mesh->vertice)
+                if ((mesh->vertice) || (mesh->vertice_q))
                     {
                     if (use_mesh_material)
                         {   // use mesh material if requested
@@ -1730,8 +2119,11 @@ namespace tgx
                     const int specularExpo = (use_mesh_material ? mesh->specular_exponent : _specularExponent);
                     _precomputeSpecularTable(specularExpo);
                     int raster_type = shader;
-                    if (mesh->normal == nullptr) TGX_SHADER_REMOVE_GOURAUD(raster_type) // gouraud shading not available so we disable it
-                    if ((mesh->texcoord == nullptr) || (mesh->texture == nullptr)) TGX_SHADER_REMOVE_TEXTURE(raster_type) // texturing not available so we disable it
+                    if ((mesh->normal == nullptr) && (mesh->normal_q == nullptr)) TGX_SHADER_REMOVE_GOURAUD(raster_type) // gouraud shading not available so we disable it
+                    // set the texture (possibly loaded in memory by the texture cache).
+                    _uni.tex = (const Image<color_t>*)mesh->texture;
+                    if ((_texcache) && (_uni.tex) && (TGX_SHADER_HAS_TEXTURE(raster_type))) _uni.tex = _texcache->get(_uni.tex);
+                    if (((mesh->texcoord == nullptr) && (mesh->texcoord_q == nullptr)) || (_uni.tex == nullptr)) TGX_SHADER_REMOVE_TEXTURE(raster_type) // texturing not available so we disable it
                     if (TGX_SHADER_HAS_GOURAUD(raster_type))
                         {
                         if (TGX_SHADER_HAS_TEXTURE(raster_type))
@@ -1765,6 +2157,41 @@ namespace tgx
         template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO>
         template<int RASTER_TYPE>
         void Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO>::_drawMesh(const Mesh3D<color_t>* mesh)
+            {
+            // the runtime options are resolved here, once per mesh, so that the
+            // rasterizer calls the shader directly for each triangle.
+            static const bool TEXTURE = (bool)(TGX_SHADER_HAS_TEXTURE(RASTER_TYPE));
+        #if (TGX_RENDERER3D_BILINEAR == 2)
+            if (_uni.use_bilinear_texturing)
+                _drawMeshTraversal<RASTER_TYPE, TEXTURE>(mesh); // same instantiation as below when not texturing
+            else
+                _drawMeshTraversal<RASTER_TYPE, false>(mesh);
+        #else
+            _drawMeshTraversal<RASTER_TYPE, TEXTURE && (TGX_RENDERER3D_BILINEAR == 1)>(mesh);
+        #endif
+            }
+
+
+
+        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO>
+        template<int RASTER_TYPE, bool TEXTURE_BILINEAR>
+        void Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO>::_drawMeshTraversal(const Mesh3D<color_t>* mesh)
+            {
+        #if (TGX_RENDERER3D_BLOCKS)
+            if (_uni.use_block_rasterization)
+                {
+                _drawMesh<RASTER_TYPE>(mesh, ShaderFixed<ZBUFFER, ORTHO, RASTER_TYPE, TEXTURE_BILINEAR, true, color_t>());
+                return;
+                }
+        #endif
+            _drawMesh<RASTER_TYPE>(mesh, ShaderFixed<ZBUFFER, ORTHO, RASTER_TYPE, TEXTURE_BILINEAR, false, color_t>());
+            }
+
+
+
+        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO>
+        template<int RASTER_TYPE, typename SHADER_FUNCTION>
+        void Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO>::_drawMesh(const Mesh3D<color_t>* mesh, SHADER_FUNCTION shader_fun)
             {
             _uni.shader_type = RASTER_TYPE;
 
@@ -1773,23 +2200,43 @@ namespace tgx
             static const float clipboundXY = (2048 / ((LX > LY) ? LX : LY));
 
             // check if the object is completely outside of the image for fast discard.
-            if (_discard(mesh->bounding_box, _projM * _r_modelViewM)) return;
+            if (_discard(mesh->bounding_box, _r_modelViewProjM)) return;
 
             // check if the clipping test should be performed for each triangle in the mesh.
-            const bool cliptestneeded = _clipTestNeeded(clipboundXY, mesh->bounding_box, _projM * _r_modelViewM);
+            const bool cliptestneeded = _clipTestNeeded(clipboundXY, mesh->bounding_box, _r_modelViewProjM);
 
             const fVec3* const tab_vert = mesh->vertice;  // array of vertices
             const fVec3* const tab_norm = mesh->normal;   // array of normals
             const fVec2* const tab_tex = mesh->texcoord;  // array of texture
             const uint16_t* face = mesh->face;      // array of triangles
 
-            // set the texture.
-            _uni.tex = (const Image<color_t>*)mesh->texture;
+            // quantized arrays (only used when the float array is missing).
+            const int16_t* const tab_vert_q = mesh->vertice_q;
+            const uint16_t* const tab_norm_q = mesh->normal_q;
+            const uint16_t* const tab_tex_q = mesh->texcoord_q;
+            const bool has_tex = ((tab_tex) || (tab_tex_q));
+            const bool has_norm = ((tab_norm) || (tab_norm_q));
 
-            ExtVec4 QQA, QQB, QQC;
-            ExtVec4* PC0 = &QQA;
-            ExtVec4* PC1 = &QQB;
-            ExtVec4* PC2 = &QQC;
+            // quantized positions are dequantized by the model-view matrix itself.
+            const fMat4 posM = (tab_vert) ? _r_modelViewM : _quantizedModelView(mesh->vertice_box);
+
+            // with Gouraud shading, the view space positions are not needed for lighting: vertices
+            // are transformed directly to clip space with a single matrix and culled in screen space.
+            static const bool FUSED = GOURAUD;
+            const fMat4 mvpM = (FUSED) ? ((tab_vert) ? _r_modelViewProjM : (_r_projM * posM)) : fMat4();
+
+            // constants of the fixed point lighting path (if used).
+            const bool fixed_lighting = (GOURAUD) && (_fixedLighting);
+            _FixedLighting FL;
+            if (fixed_lighting) _setupFixedLighting<TEXTURE>(FL);
+
+            ExtVec4 QQ[3];
+            ExtVec4* PC0 = QQ;
+            ExtVec4* PC1 = QQ + 1;
+            ExtVec4* PC2 = QQ + 2;
+
+            // snapped vertex positions shared between consecutive triangles of a chain.
+            RasterizerStripCache strip;
 
             int nbt;
             while ((nbt = *(face++)) > 0)
@@ -1797,49 +2244,74 @@ namespace tgx
 
                 // load the first triangle
                 const uint16_t v0 = *(face++);
-                if (TEXTURE) PC0->indt = *(face++); else { if (tab_tex) face++; }
-                if (GOURAUD) PC0->indn = *(face++); else { if (tab_norm) face++; }
+                if (TEXTURE) PC0->indt = *(face++); else { if (has_tex) face++; }
+                if (GOURAUD) PC0->indn = *(face++); else { if (has_norm) face++; }
 
                 const uint16_t v1 = *(face++);
-                if (TEXTURE) PC1->indt = *(face++); else { if (tab_tex) face++; }
-                if (GOURAUD) PC1->indn = *(face++); else { if (tab_norm) face++; }
+                if (TEXTURE) PC1->indt = *(face++); else { if (has_tex) face++; }
+                if (GOURAUD) PC1->indn = *(face++); else { if (has_norm) face++; }
 
                 const uint16_t v2 = *(face++);
-                if (TEXTURE) PC2->indt = *(face++); else { if (tab_tex) face++; }
-                if (GOURAUD) PC2->indn = *(face++); else { if (tab_norm) face++; }
+                if (TEXTURE) PC2->indt = *(face++); else { if (has_tex) face++; }
+                if (GOURAUD) PC2->indn = *(face++); else { if (has_norm) face++; }
 
                 // compute vertices position because we are sure we will need them...
-                PC2->P = _r_modelViewM.mult1(tab_vert[v2]);
-                PC0->P = _r_modelViewM.mult1(tab_vert[v0]);
-                PC1->P = _r_modelViewM.mult1(tab_vert[v1]);
+                if (FUSED)
+                    {
+                    _projectVertexFused(*PC2, PC2->P.z, mvpM, posM, _meshVertex(tab_vert, tab_vert_q, v2));
+                    _projectVertexFused(*PC0, PC0->P.z, mvpM, posM, _meshVertex(tab_vert, tab_vert_q, v0));
+                    _projectVertexFused(*PC1, PC1->P.z, mvpM, posM, _meshVertex(tab_vert, tab_vert_q, v1));
+                    }
+                else
+                    {
+                    PC2->P = posM.mult1(_meshVertex(tab_vert, tab_vert_q, v2));
+                    PC0->P = posM.mult1(_meshVertex(tab_vert, tab_vert_q, v0));
+                    PC1->P = posM.mult1(_meshVertex(tab_vert, tab_vert_q, v1));
+                    }
 
                 // ...but use lazy computation of other vertex attributes
                 PC0->missedP = true;
                 PC1->missedP = true;
                 PC2->missedP = true;
+                strip.reset();
 
                 while (1)
                     {
                     // face culling
-                    fVec3 faceN = crossProduct(PC1->P - PC0->P, PC2->P - PC0->P);
-                    const float cu = (ORTHO) ? dotProduct(faceN, fVec3(0.0f, 0.0f, -1.0f)) : dotProduct(faceN, PC0->P);
+                    fVec3 faceN;
+                    float cu;
+                    if (FUSED)
+                        { // screen space (same sign as below for vertices in front of the camera, the others are clipped anyway)
+                        cu = (PC1->x - PC0->x) * (PC2->y - PC0->y) - (PC1->y - PC0->y) * (PC2->x - PC0->x);
+                        }
+                    else
+                        {
+                        faceN = crossProduct(PC1->P - PC0->P, PC2->P - PC0->P);
+                        cu = (ORTHO) ? dotProduct(faceN, fVec3(0.0f, 0.0f, -1.0f)) : dotProduct(faceN, PC0->P);
+                        }
                     if (cu * _culling_dir > 0) goto rasterize_next_triangle; // skip triangle !
                     // triangle is not culled
                     if (cliptestneeded)
                         {
                         // test if clipping is needed
-                        *((fVec4*)PC2) = _projM * PC2->P;
-                        if (ORTHO) { PC2->w = 2.0f - PC2->z; }
-                        else { PC2->zdivide(); }
+                        if (!FUSED)
+                            {
+                            *((fVec4*)PC2) = _r_projM * PC2->P;
+                            if (ORTHO) { PC2->w = 2.0f - PC2->z; }
+                            else { PC2->zdivide(); }
+                            }
                         bool needclip = (PC2->P.z >= 0)
                             | (PC2->x < -clipboundXY) | (PC2->x > clipboundXY)
                             | (PC2->y < -clipboundXY) | (PC2->y > clipboundXY)
                             | (PC2->z < -1) | (PC2->z > 1);
                         if (PC0->missedP)
                             {
-                            *((fVec4*)PC0) = _projM * PC0->P;
-                            if (ORTHO) { PC0->w = 2.0f - PC0->z; }
-                            else { PC0->zdivide(); }
+                            if (!FUSED)
+                                {
+                                *((fVec4*)PC0) = _r_projM * PC0->P;
+                                if (ORTHO) { PC0->w = 2.0f - PC0->z; }
+                                else { PC0->zdivide(); }
+                                }
                             needclip |= (PC0->P.z >= 0)
                                 | (PC0->x < -clipboundXY) | (PC0->x > clipboundXY)
                                 | (PC0->y < -clipboundXY) | (PC0->y > clipboundXY)
@@ -1847,9 +2319,12 @@ namespace tgx
                             }
                         if (PC1->missedP)
                             {
-                            *((fVec4*)PC1) = _projM * PC1->P;
-                            if (ORTHO) { PC1->w = 2.0f - PC1->z; }
-                            else { PC1->zdivide(); }
+                            if (!FUSED)
+                                {
+                                *((fVec4*)PC1) = _r_projM * PC1->P;
+                                if (ORTHO) { PC1->w = 2.0f - PC1->z; }
+                                else { PC1->zdivide(); }
+                                }
                             needclip |= (PC1->P.z >= 0)
                                 | (PC1->x < -clipboundXY) | (PC1->x > clipboundXY)
                                 | (PC1->y < -clipboundXY) | (PC1->y > clipboundXY)
@@ -1859,21 +2334,21 @@ namespace tgx
                         // *** TODO : implement correct clipping ***
                         if (needclip) goto rasterize_next_triangle;
                         }
-                    else
+                    else if (!FUSED)
                         {
                         // skip the clipping test
-                        *((fVec4*)PC2) = _projM * PC2->P;
+                        *((fVec4*)PC2) = _r_projM * PC2->P;
                         if (ORTHO) { PC2->w = 2.0f - PC2->z; }
                         else { PC2->zdivide(); }
                         if (PC0->missedP)
                             {
-                            *((fVec4*)PC0) = _projM * PC0->P;
+                            *((fVec4*)PC0) = _r_projM * PC0->P;
                             if (ORTHO) { PC0->w = 2.0f - PC0->z; }
                             else { PC0->zdivide(); }
                             }
                         if (PC1->missedP)
                             {
-                            *((fVec4*)PC1) = _projM * PC1->P;
+                            *((fVec4*)PC1) = _r_projM * PC1->P;
                             if (ORTHO) { PC1->w = 2.0f - PC1->z; }
                             else { PC1->zdivide(); }
                             }
@@ -1885,18 +2360,38 @@ namespace tgx
 
                         // reverse normal only when culling is disabled (and we assume in this case that normals are given for the CCW face).
                         const float icu = (_culling_dir != 0) ? 1.0f : ((cu > 0) ? -1.0f : 1.0f);
-                        if (PC0->missedP)
-                            {
-                            PC0->N = _r_modelViewM.mult0(tab_norm[PC0->indn]);
-                            PC0->color = _phong<TEXTURE>(icu * dotProduct(PC0->N, _r_light_inorm), icu * dotProduct(PC0->N, _r_H_inorm));
+                        if (fixed_lighting)
+                            { // fixed point path
+                            const int32_t isg = (icu > 0) ? 1 : -1;
+                            int32_t dl, dh;
+                            if (PC0->missedP)
+                                {
+                                _meshNormalDotsFixed(FL, tab_norm, tab_norm_q, PC0->indn, dl, dh);
+                                PC0->color = _phongFixed(FL, isg * dl, isg * dh);
+                                }
+                            if (PC1->missedP)
+                                {
+                                _meshNormalDotsFixed(FL, tab_norm, tab_norm_q, PC1->indn, dl, dh);
+                                PC1->color = _phongFixed(FL, isg * dl, isg * dh);
+                                }
+                            _meshNormalDotsFixed(FL, tab_norm, tab_norm_q, PC2->indn, dl, dh);
+                            PC2->color = _phongFixed(FL, isg * dl, isg * dh);
                             }
-                        if (PC1->missedP)
+                        else
                             {
-                            PC1->N = _r_modelViewM.mult0(tab_norm[PC1->indn]);
-                            PC1->color = _phong<TEXTURE>(icu * dotProduct(PC1->N, _r_light_inorm), icu * dotProduct(PC1->N, _r_H_inorm));
+                            if (PC0->missedP)
+                                {
+                                PC0->N = _r_modelViewM.mult0(_meshNormal(tab_norm, tab_norm_q, PC0->indn));
+                                PC0->color = _phong<TEXTURE>(icu * dotProduct(PC0->N, _r_light_inorm), icu * dotProduct(PC0->N, _r_H_inorm));
+                                }
+                            if (PC1->missedP)
+                                {
+                                PC1->N = _r_modelViewM.mult0(_meshNormal(tab_norm, tab_norm_q, PC1->indn));
+                                PC1->color = _phong<TEXTURE>(icu * dotProduct(PC1->N, _r_light_inorm), icu * dotProduct(PC1->N, _r_H_inorm));
+                                }
+                            PC2->N = _r_modelViewM.mult0(_meshNormal(tab_norm, tab_norm_q, PC2->indn));
+                            PC2->color = _phong<TEXTURE>(icu * dotProduct(PC2->N, _r_light_inorm), icu * dotProduct(PC2->N, _r_H_inorm));
                             }
-                        PC2->N = _r_modelViewM.mult0(tab_norm[PC2->indn]);
-                        PC2->color = _phong<TEXTURE>(icu * dotProduct(PC2->N, _r_light_inorm), icu * dotProduct(PC2->N, _r_H_inorm));
                         }
                     else
                         { // flat shading : color on faces
@@ -1907,9 +2402,9 @@ namespace tgx
 
                     if (TEXTURE)
                         { // compute texture vectors if needed
-                        if (PC0->missedP) { PC0->T = tab_tex[PC0->indt]; }
-                        if (PC1->missedP) { PC1->T = tab_tex[PC1->indt]; }
-                        PC2->T = tab_tex[PC2->indt];
+                        if (PC0->missedP) { PC0->T = _meshTexcoord(tab_tex, tab_tex_q, mesh->texcoord_box, PC0->indt); }
+                        if (PC1->missedP) { PC1->T = _meshTexcoord(tab_tex, tab_tex_q, mesh->texcoord_box, PC1->indt); }
+                        PC2->T = _meshTexcoord(tab_tex, tab_tex_q, mesh->texcoord_box, PC2->indt);
                         }
 
                     // attributes are now all up to date
@@ -1918,7 +2413,8 @@ namespace tgx
                     PC2->missedP = false;
 
                     // go rasterize !                   
-                    rasterizeTriangle<LX, LY> ((RasterizerVec4)QQA, (RasterizerVec4)QQB, (RasterizerVec4)QQC, _ox, _oy, _uni, shader_select<ZBUFFER, ORTHO, color_t>);
+                    if ((ZBUFFER) && (_uni.query_count)) rasterizeTriangleStrip<LX, LY>(strip, QQ[0], QQ[1], QQ[2], _ox, _oy, _uni, shader_DepthQuery<color_t>);
+                    rasterizeTriangleStrip<LX, LY>(strip, QQ[0], QQ[1], QQ[2], _ox, _oy, _uni, shader_fun);
 
                 
                 rasterize_next_triangle:
@@ -1928,10 +2424,14 @@ namespace tgx
                     // get the next triangle
                     const uint16_t nv2 = *(face++);
                     swap(((nv2 & 32768) ? PC0 : PC1), PC2);
-                    if (TEXTURE) PC2->indt = *(face++); else { if (tab_tex) face++; }
-                    if (GOURAUD) PC2->indn = *(face++);  else { if (tab_norm) face++; }
-                    PC2->P = _r_modelViewM.mult1(tab_vert[nv2 & 32767]);
+                    if (TEXTURE) PC2->indt = *(face++); else { if (has_tex) face++; }
+                    if (GOURAUD) PC2->indn = *(face++);  else { if (has_norm) face++; }
+                    if (FUSED)
+                        _projectVertexFused(*PC2, PC2->P.z, mvpM, posM, _meshVertex(tab_vert, tab_vert_q, nv2 & 32767));
+                    else
+                        PC2->P = posM.mult1(_meshVertex(tab_vert, tab_vert_q, nv2 & 32767));
                     PC2->missedP = true;
+                    strip.invalidate((int)(PC2 - QQ));
                     }
                 }
             }
@@ -2072,6 +2572,89 @@ namespace tgx
             }
 
 
+
+        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO>
+        bool Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO>::testBoxVisible(const fBox3& box, uint32_t* nb_samples)
+            {
+            static_assert(ZBUFFER == true, "the testBoxVisible() method can only be used with template parameter ZBUFFER = true");
+            if (nb_samples) *nb_samples = 0;
+            if ((_uni.im == nullptr) || (!_uni.im->isValid())) return false;   // no valid image
+            if ((_uni.zbuf == nullptr) || (_zbuffer_len < _uni.im->lx() * _uni.im->ly())) return false; // no zbuffer
+            if (_discard(box, _r_modelViewProjM)) return false; // outside of the viewport
+
+            // corner i has coordinates (i & 1 ? maxX : minX, i & 2 ? maxY : minY, i & 4 ? maxZ : minZ)
+            static const float clipboundXY = (2048 / ((LX > LY) ? LX : LY));
+            fVec4 Q[8];
+            RasterizerVec4 PC[8];
+            bool needclip = false;
+            for (int i = 0; i < 8; i++)
+                {
+                Q[i] = _r_modelViewM.mult1(fVec3((i & 1) ? box.maxX : box.minX, (i & 2) ? box.maxY : box.minY, (i & 4) ? box.maxZ : box.minZ));
+                (*((fVec4*)&PC[i])) = _r_projM * Q[i];
+                if (ORTHO) { PC[i].w = 2.0f - PC[i].z; } else { PC[i].zdivide(); }
+                needclip |= (Q[i].z >= 0)
+                          | (PC[i].x < -clipboundXY) | (PC[i].x > clipboundXY)
+                          | (PC[i].y < -clipboundXY) | (PC[i].y > clipboundXY)
+                          | (PC[i].z < -1) | (PC[i].z > 1);
+                }
+            if (needclip)
+                { // conservative answer
+                if (nb_samples) *nb_samples = (uint32_t)(_uni.im->lx() * _uni.im->ly());
+                return true;
+                }
+
+            // the 6 faces: opposite faces are consecutive (the winding does not matter).
+            static const uint8_t faces[6][4] = { {0,4,6,2}, {1,3,7,5}, {0,1,5,4}, {2,6,7,3}, {0,2,3,1}, {4,5,7,6} };
+            const fVec4 C = (Q[0] + Q[7]) * 0.5f; // center of the box
+            uint32_t count = 0;
+            uint32_t* const saved_count = _uni.query_count;
+            _uni.query_count = &count;
+            for (int f = 0; f < 6; f++)
+                {
+                const uint8_t* F = faces[f];
+                const fVec4 N = crossProduct(Q[F[1]] - Q[F[0]], Q[F[2]] - Q[F[0]]);
+                const float in = dotProduct(N, C - Q[F[0]]); // sign of the inner side of the face
+                const float eye = (ORTHO) ? N.z : -dotProduct(N, Q[F[0]]); // sign of the side of the camera
+                // keep the faces with the camera on their outer side (only one face of each pair if the box is flat).
+                if (!(((in < 0) && (eye > 0)) || ((in > 0) && (eye < 0)) || ((in == 0) && ((f & 1) == 0)))) continue;
+                rasterizeTriangle<LX, LY>(PC[F[0]], PC[F[1]], PC[F[2]], _ox, _oy, _uni, shader_DepthQuery<color_t>);
+                rasterizeTriangle<LX, LY>(PC[F[0]], PC[F[2]], PC[F[3]], _ox, _oy, _uni, shader_DepthQuery<color_t>);
+                }
+            _uni.query_count = saved_count;
+            if (nb_samples) *nb_samples = count;
+            return (count > 0);
+            }
+
+
+
+        template<typename color_t, int LX, int LY, bool ZBUFFER, bool ORTHO>
+        int Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO>::testBoxFrustum(const fBox3& box)
+            {
+            if ((_uni.im == nullptr) || (!_uni.im->isValid())) return -1;   // no valid image
+            // bounds of the image in normalized coordinates (same as _discard())
+            const float ilx = 2.0f / LX;
+            const float bx = (_ox - 1) * ilx - 1.0f;
+            const float Bx = (_ox + _uni.im->width() + 1) * ilx - 1.0f;
+            const float ily = 2.0f / LY;
+            const float by = (_oy - 1) * ily - 1.0f;
+            const float By = (_oy + _uni.im->height() + 1) * ily - 1.0f;
+            int out_all = 63;   // planes with all the corners outside
+            int out_any = 0;    // planes with at least one corner outside
+            for (int i = 0; i < 8; i++)
+                {
+                // the frustum is the intersection of 6 half-spaces in clip space (linear in x,y,z,w).
+                const fVec4 S = _r_modelViewProjM.mult1(fVec3((i & 1) ? box.maxX : box.minX, (i & 2) ? box.maxY : box.minY, (i & 4) ? box.maxZ : box.minZ));
+                const int fl = ((S.x < bx * S.w) ? 1 : 0) | ((S.x > Bx * S.w) ? 2 : 0)
+                             | ((S.y < by * S.w) ? 4 : 0) | ((S.y > By * S.w) ? 8 : 0)
+                             | ((S.z < -S.w) ? 16 : 0) | ((S.z > S.w) ? 32 : 0);
+                out_all &= fl;
+                out_any |= fl;
+                }
+            if (out_all) return -1;
+            return ((out_any) ? 0 : 1);
+            }
+
+
 }
 
 
@@ -0,0 +1,464 @@
+/** @file Scene3D.h */
+//
+// Copyright 2020 Arvind Singh
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+//version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _TGX_SCENE3D_H_
+#define _TGX_SCENE3D_H_
+
+// only C++, no plain C
+#ifdef __cplusplus
+
+
+#include "Misc.h"
+#include "Vec3.h"
+#include "Vec4.h"
+#include "Mat4.h"
+#include "Box3.h"
+#include "Color.h"
+#include "Mesh3D.h"
+#include "Renderer3D.h"
+
+#include <stdint.h>
+
+
+namespace tgx
+{
+
+
+    /**
+    * Collection of mesh instances (a mesh and its model matrix) organized in a bounding
+    * volume hierarchy (BVH).
+    *
+    * Each object is enclosed in a box in world space and the boxes are grouped in a binary
+    * tree. When the scene is drawn, the tree is traversed from the root and a whole subtree
+    * is skipped as soon as its box is outside of the view frustum (or hidden behind what was
+    * already drawn, when occlusion testing is enabled). Subtrees completely inside of the
+    * frustum are not tested any further so the cost of the culling grows with the number of
+    * visible objects instead of the total number of objects.
+    *
+    * Example:
+    *
+    *   Scene3D<RGB565, 128> scene;
+    *   int tree = scene.addObject(&tree_mesh, M1);   // add the objects once
+    *   ...
+    *   scene.setTransform(tree, M2);                 // an object moved: the tree is refitted
+    *   scene.draw(renderer, TGX_SHADER_GOURAUD);     // draw the visible objects
+    *
+    * The tree is (re)built on the next call to draw() after objects are added and only its
+    * boxes are updated (refit) when objects move. Call build() explicitly to rebuild the tree
+    * after objects moved a lot (the refitted tree stays valid but becomes less efficient).
+    *
+    * The scene does not own the meshes. No memory is allocated: MAXOBJECTS sets the maximum
+    * number of objects.
+    **/
+    template<typename color_t, int MAXOBJECTS = 64> class Scene3D
+    {
+
+        // make sure right away that the template parameter is admissible to prevent cryptic error message later.
+        static_assert(is_color<color_t>::value, "color_t must be one of the color types defined in color.h");
+
+        static_assert((MAXOBJECTS >= 1) && (MAXOBJECTS <= 16000), "MAXOBJECTS must be between 1 and 16000");
+
+    public:
+
+
+        /**
+        * Culling counters, accumulated since the last call to resetStats().
+        **/
+        struct Stats
+            {
+            uint32_t nodes_visited;     // nodes of the tree reached during the traversals
+            uint32_t frustum_tests;     // boxes tested against the frustum
+            uint32_t frustum_culled;    // subtrees skipped because outside of the frustum
+            uint32_t occlusion_tests;   // boxes tested against the zbuffer
+            uint32_t occlusion_culled;  // subtrees skipped because hidden
+            uint32_t objects_drawn;     // objects sent to drawMesh()
+            };
+
+
+        /**
+        * Constructor. Create an empty scene.
+        **/
+        Scene3D() : _nb(0), _nbnodes(0), _needbuild(false), _needrefit(false)
+            {
+            resetStats();
+            }
+
+
+        /**
+        * Add an object to the scene and return its id (or -1 if the scene is full).
+        *
+        * - mesh : the mesh (with its chained meshes, see Mesh3D::next). Its bounding boxes must
+        *          be set otherwise the object is never culled.
+        * - M : the model matrix of the object.
+        **/
+        int addObject(const Mesh3D<color_t>* mesh, const fMat4& M)
+            {
+            if ((mesh == nullptr) || (_nb >= MAXOBJECTS)) return -1;
+            _Object& O = _objects[_nb];
+            O.mesh = mesh;
+            O.M = M;
+            O.enabled = true;
+            _updateBox(O);
+            _needbuild = true;
+            return _nb++;
+            }
+
+
+        /**
+        * Change the model matrix of an object. The boxes of the tree are updated on the next
+        * call to draw() (or refit()).
+        **/
+        void setTransform(int id, const fMat4& M)
+            {
+            if ((id < 0) || (id >= _nb)) return;
+            _objects[id].M = M;
+            _updateBox(_objects[id]);
+            _needrefit = true;
+            }
+
+
+        /**
+        * Return the model matrix of an object.
+        **/
+        fMat4 getTransform(int id) const
+            {
+            return _objects[id].M;
+            }
+
+
+        /**
+        * Enable or disable the drawing of an object (disabled objects stay in the tree).
+        **/
+        void setEnabled(int id, bool enabled)
+            {
+            if ((id < 0) || (id >= _nb)) return;
+            _objects[id].enabled = enabled;
+            }
+
+
+        /**
+        * Remove all the objects.
+        **/
+        void clear()
+            {
+            _nb = 0;
+            _nbnodes = 0;
+            _needbuild = false;
+            _needrefit = false;
+            }
+
+
+        /**
+        * Return the number of objects in the scene.
+        **/
+        int nbObjects() const { return _nb; }
+
+
+        /**
+        * Return the box (in world space) containing all the objects.
+        **/
+        fBox3 boundingBox()
+            {
+            _update();
+            fBox3 B;
+            B.empty();
+            if (_nbnodes > 0) B = _nodes[0].box;
+            return B;
+            }
+
+
+        /**
+        * Build the tree from scratch. The objects are split recursively at the median of
+        * their centers along the largest dimension of the set.
+        **/
+        void build()
+            {
+            _nbnodes = 0;
+            for (int i = 0; i < _nb; i++) _order[i] = (int16_t)i;
+            if (_nb > 0) _build(0, _nb);
+            _needbuild = false;
+            _needrefit = false;
+            }
+
+
+        /**
+        * Update the boxes of the tree after objects moved (without changing its structure).
+        * The children of a node always come after it in the node array so a single backward
+        * pass suffices.
+        **/
+        void refit()
+            {
+            for (int i = _nbnodes - 1; i >= 0; i--)
+                {
+                _Node& N = _nodes[i];
+                N.box = (N.obj >= 0) ? _objects[N.obj].box : (_nodes[N.left].box | _nodes[N.right].box);
+                }
+            _needrefit = false;
+            }
+
+
+        /**
+        * Draw the visible objects of the scene.
+        *
+        * - renderer : the renderer to use. Its model matrix is restored on return.
+        * - shader : the shader passed to drawMesh() for each object.
+        * - use_occlusion : true to skip the subtrees whose box is hidden by what was already
+        *                   drawn (see Renderer3D::testBoxVisible()). Only used when the
+        *                   renderer has a zbuffer. The tree is traversed front to back so
+        *                   nearby objects are drawn first and can hide the ones behind.
+        * - use_mesh_material : passed to drawMesh().
+        *
+        * Return 0 on success or the (negative) error code returned by drawMesh().
+        **/
+        template<int LX, int LY, bool ZBUFFER, bool ORTHO>
+        int draw(Renderer3D<color_t, LX, LY, ZBUFFER, ORTHO>& renderer, int shader, bool use_occlusion = false, bool use_mesh_material = true)
+            {
+            _update();
+            if (_nbnodes == 0) return 0;
+            const fMat4 savedM = renderer.getModelMatrix();
+            const fMat4 V = renderer.getViewMatrix();
+            fMat4 I;
+            I.setIdentity();
+            renderer.setModelMatrix(I);
+            bool identity = true;   // true when the renderer model matrix is the identity (for testing boxes).
+            int err = 0;
+
+            // stack of nodes to visit with a flag telling if their box is known to be inside the frustum.
+            int16_t stack[2 * _TREEDEPTH];
+            bool inside[2 * _TREEDEPTH];
+            int sp = 0;
+            stack[sp] = 0;
+            inside[sp++] = false;
+            while (sp > 0)
+                {
+                sp--;
+                const _Node& N = _nodes[stack[sp]];
+                bool in = inside[sp];
+                _stats.nodes_visited++;
+                if ((N.obj >= 0) && (!_objects[N.obj].enabled)) continue;
+                if ((!in) || (use_occlusion))
+                    {
+                    if (!identity) { renderer.setModelMatrix(I); identity = true; }
+                    if (!in)
+                        {
+                        _stats.frustum_tests++;
+                        const int r = renderer.testBoxFrustum(N.box);
+                        if (r < 0) { _stats.frustum_culled++; continue; }
+                        in = (r > 0);
+                        }
+                    if ((ZBUFFER) && (use_occlusion))
+                        {
+                        _stats.occlusion_tests++;
+                        if (!_Occlusion<ZBUFFER>::visible(renderer, N.box)) { _stats.occlusion_culled++; continue; }
+                        }
+                    }
+                if (N.obj >= 0)
+                    { // leaf: draw the object
+                    renderer.setModelMatrix(_objects[N.obj].M);
+                    identity = false;
+                    const int e = renderer.drawMesh(shader, _objects[N.obj].mesh, use_mesh_material, true);
+                    if (e < 0) { err = e; break; }
+                    _stats.objects_drawn++;
+                    continue;
+                    }
+                // push the farthest child first so that the nearest one is visited first.
+                const float zl = V.mult1(_nodes[N.left].box.center()).z;
+                const float zr = V.mult1(_nodes[N.right].box.center()).z;
+                const int16_t first = (zl >= zr) ? N.left : N.right; // the camera looks toward -z
+                const int16_t second = (zl >= zr) ? N.right : N.left;
+                stack[sp] = second;
+                inside[sp++] = in;
+                stack[sp] = first;
+                inside[sp++] = in;
+                }
+            renderer.setModelMatrix(savedM);
+            return err;
+            }
+
+
+        /**
+        * Return the counters accumulated since the last call to resetStats().
+        **/
+        Stats getStats() const { return _stats; }
+
+
+        /**
+        * Reset the counters.
+        **/
+        void resetStats()
+            {
+            _stats.nodes_visited = 0;
+            _stats.frustum_tests = 0;
+            _stats.frustum_culled = 0;
+            _stats.occlusion_tests = 0;
+            _stats.occlusion_culled = 0;
+            _stats.objects_drawn = 0;
+            }
+
+
+    private:
+
+
+        /** maximum depth of the tree (the median split halves the number of objects at each level) */
+        static const int _TREEDEPTH = 16;
+
+
+        /** an object of the scene */
+        struct _Object
+            {
+            const Mesh3D<color_t>* mesh;    // mesh (and its chained meshes)
+            fMat4 M;                        // model matrix
+            fBox3 box;                      // box containing the object in world space
+            bool enabled;                   // false to skip the object
+            };
+
+
+        /** a node of the tree */
+        struct _Node
+            {
+            fBox3 box;                      // box containing all the objects of the subtree
+            int16_t left, right;            // children (inner node)
+            int16_t obj;                    // object (leaf) or -1 (inner node)
+            };
+
+
+        /** occlusion test, only available with a zbuffer */
+        template<bool HAS_ZBUFFER, bool DUMMY = true> struct _Occlusion
+            {
+            template<typename RENDERER> static bool visible(RENDERER& renderer, const fBox3& box) { return renderer.testBoxVisible(box); }
+            };
+
+        template<bool DUMMY> struct _Occlusion<false, DUMMY>
+            {
+            template<typename RENDERER> static bool visible(RENDERER&, const fBox3&) { return true; }
+            };
+
+
+        /** rebuild or refit the tree if needed */
+        void _update()
+            {
+            if (_needbuild) build(); else if (_needrefit) refit();
+            }
+
+
+        /** compute the box of an object in world space */
+        void _updateBox(_Object& O)
+            {
+            O.box.empty();
+            for (const Mesh3D<color_t>* mesh = O.mesh; mesh != nullptr; mesh = mesh->next)
+                {
+                const fBox3& bb = mesh->bounding_box;
+                if ((bb.minX == 0) && (bb.maxX == 0) && (bb.minY == 0) && (bb.maxY == 0) && (bb.minZ == 0) && (bb.maxZ == 0))
+                    { // uninitialized bounding box: the object is never culled.
+                    const float H = 1.0e15f;
+                    O.box = fBox3(-H, H, -H, H, -H, H);
+                    return;
+                    }
+                for (int i = 0; i < 8; i++)
+                    {
+                    const fVec4 P = O.M.mult1(fVec3((i & 1) ? bb.maxX : bb.minX, (i & 2) ? bb.maxY : bb.minY, (i & 4) ? bb.maxZ : bb.minZ));
+                    O.box |= fBox3(fVec3(P.x, P.y, P.z));
+                    }
+                }
+            }
+
+
+        /** coordinate of the center of an object along an axis */
+        float _center(int obj, int axis) const
+            {
+            const fBox3& B = _objects[obj].box;
+            return (axis == 0) ? (B.minX + B.maxX) : ((axis == 1) ? (B.minY + B.maxY) : (B.minZ + B.maxZ));
+            }
+
+
+        /** reorder _order[first, first + count[ so that the element at position k is at its sorted place along an axis */
+        void _select(int first, int count, int k, int axis)
+            {
+            int lo = first;
+            int hi = first + count - 1;
+            while (lo < hi)
+                {
+                const float pivot = _center(_order[(lo + hi) >> 1], axis);
+                int i = lo;
+                int j = hi;
+                while (i <= j)
+                    {
+                    while (_center(_order[i], axis) < pivot) i++;
+                    while (_center(_order[j], axis) > pivot) j--;
+                    if (i <= j)
+                        {
+                        const int16_t t = _order[i]; _order[i] = _order[j]; _order[j] = t;
+                        i++;
+                        j--;
+                        }
+                    }
+                if (k <= j) hi = j; else if (k >= i) lo = i; else return;
+                }
+            }
+
+
+        /** build the subtree for the objects _order[first, first + count[ and return the index of its root */
+        int16_t _build(int first, int count)
+            {
+            const int16_t n = (int16_t)(_nbnodes++);
+            _Node& N = _nodes[n];
+            if (count == 1)
+                {
+                N.obj = _order[first];
+                N.left = N.right = -1;
+                N.box = _objects[N.obj].box;
+                return n;
+                }
+            // split along the largest dimension of the box of the centers
+            fBox3 C;
+            C.empty();
+            for (int i = first; i < first + count; i++) C |= fBox3(_objects[_order[i]].box.center());
+            const float ex = C.maxX - C.minX, ey = C.maxY - C.minY, ez = C.maxZ - C.minZ;
+            const int axis = ((ex >= ey) && (ex >= ez)) ? 0 : ((ey >= ez) ? 1 : 2);
+            const int half = count >> 1;
+            _select(first, count, first + half, axis);
+            N.obj = -1;
+            const int16_t l = _build(first, half);
+            const int16_t r = _build(first + half, count - half);
+            _nodes[n].left = l;
+            _nodes[n].right = r;
+            _nodes[n].box = _nodes[l].box | _nodes[r].box;
+            return n;
+            }
+
+
+        int         _nb;                            // number of objects
+        int         _nbnodes;                       // number of nodes in the tree
+        bool        _needbuild;                     // true if the tree must be rebuilt
+        bool        _needrefit;                     // true if the boxes of the tree must be updated
+        _Object     _objects[MAXOBJECTS];           // the objects
+        int16_t     _order[MAXOBJECTS];             // objects ordered by the tree leaves
+        _Node       _nodes[2 * MAXOBJECTS - 1];     // the tree (root at index 0)
+        Stats       _stats;                         // culling counters
+
+    };
+
+
+}
+
+
+#endif
+
+#endif
+
+/** end of file **/
+
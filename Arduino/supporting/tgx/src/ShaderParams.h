@@ -91,7 +91,9 @@ namespace tgx
 		float opacity;					// opacity multiplier (currently used only with the 2D shader)
 		const Image<color_t_tex>* tex;	// pointer to the texture (when using texturing).
         bool use_bilinear_texturing;    // true to use bilinear point sampling (when using texturing).
+        bool use_block_rasterization;   // true to traverse triangles by 8x8 blocks instead of scanlines (3D shaders only).
 		color_t_tex mask_color;			// 'transparent color' when masking is enabled (on for the 2D shader).
+		uint32_t* query_count;			// sample counter incremented by shader_DepthQuery() (occlusion queries).
 		};
 
 
@@ -23,11 +23,29 @@
 
 
 #include "ShaderParams.h"
+#include "Simd.h"
 
 namespace tgx
 {
 
 
+#if (TGX_SIMD)
+	/**
+	* Number of pixels of a scanline, starting at bx and before lx, where the edge functions
+	* C2 and C3 (incremented by dx2 and dx3 at each pixel) are both non-negative: this is the
+	* number of iterations of the inner loops of the scanline shaders below.
+	**/
+	TGX_INLINE inline int32_t _spanLength(int32_t bx, int32_t lx, int32_t C2, int32_t dx2, int32_t C3, int32_t dx3)
+		{
+		if ((C2 | C3) < 0) return 0;
+		int32_t n = lx - bx;
+		if (dx2 < 0) n = min(n, C2 / (-dx2) + 1);
+		if (dx3 < 0) n = min(n, C3 / (-dx3) + 1);
+		return n;
+		}
+#endif
+
+
 
 	/**
 	* FLAT SHADING (NO ZBUFFER)
@@ -86,6 +104,12 @@ namespace tgx
 
 			int32_t C2 = O2 + (dx2 * bx);
 			int32_t C3 = O3 + (dx3 * bx);
+#if (TGX_SIMD)
+			{ // vector kernel for the beginning of the span (host builds)
+			const int32_t k = simdFill(buf + bx, col, _spanLength(bx, lx, C2, dx2, C3, dx3));
+			bx += k; C2 += k * dx2; C3 += k * dx3;
+			}
+#endif
 			while ((bx < lx) && ((C2 | C3) >= 0))
 				{
 				buf[bx] = col;
@@ -164,6 +188,13 @@ namespace tgx
 
 			int32_t C2 = O2 + (dx2 * bx);
 			int32_t C3 = O3 + (dx3 * bx);
+#if (TGX_SIMD)
+			{ // vector kernel for the beginning of the span (host builds)
+			float cw = 0;
+			const int32_t k = simdGouraud<false>(buf + bx, nullptr, _spanLength(bx, lx, C2, dx2, C3, dx3), C2, dx2, C3, dx3, aera, col1, col2, col3, cw, 0.0f);
+			bx += k; C2 += k * dx2; C3 += k * dx3;
+			}
+#endif
 			while ((bx < lx) && ((C2 | C3) >= 0))
 				{
 				buf[bx] = interpolateColorsTriangle(col2, C2, col3, C3, col1, aera);
@@ -564,6 +595,12 @@ namespace tgx
 			int32_t C3 = O3 + (dx3 * bx);
 			float cw = ((C1 * fP1a) + (C2 * fP2a) + (C3 * fP3a));
 
+#if (TGX_SIMD)
+			{ // vector kernel for the beginning of the span (host builds)
+			const int32_t k = simdFillZbuffer(buf + bx, zbuf + bx, col, _spanLength(bx, lx, C2, dx2, C3, dx3), cw, dw);
+			bx += k; C2 += k * dx2; C3 += k * dx3;
+			}
+#endif
 			while ((bx < lx) && ((C2 | C3) >= 0))
 				{
 				float& W = zbuf[bx];
@@ -663,6 +700,12 @@ namespace tgx
 			int32_t C3 = O3 + (dx3 * bx);
 			float cw = ((C1 * fP1a) + (C2 * fP2a) + (C3 * fP3a));
 
+#if (TGX_SIMD)
+			{ // vector kernel for the beginning of the span (host builds)
+			const int32_t k = simdGouraud<true>(buf + bx, zbuf + bx, _spanLength(bx, lx, C2, dx2, C3, dx3), C2, dx2, C3, dx3, aera, col1, col2, col3, cw, dw);
+			bx += k; C2 += k * dx2; C3 += k * dx3;
+			}
+#endif
 			while ((bx < lx) && ((C2 | C3) >= 0))
 				{
 				float& W = zbuf[bx];
@@ -1605,8 +1648,8 @@ namespace tgx
                         }
                     else
                         {
-                        const int ttx = ((int)((tx))) & (texsize_x);
-                        const int tty = ((int)((ty))) & (texsize_y);
+                        const int ttx = ((int)((tx))) & (texsize_x_mm);
+                        const int tty = ((int)((ty))) & (texsize_y_mm);
                         col = tex[ttx + (tty)*texstride];
                         } 
                                 
@@ -1640,6 +1683,531 @@ namespace tgx
 
 
 
+	/**
+	* DEPTH TEST ONLY (OCCLUSION QUERIES)
+	*
+	* Add to *data.query_count the number of pixels of the triangle that pass the depth test.
+	* Nothing is written, neither in the image nor in the z-buffer. The depth is interpolated
+	* exactly as in the z-buffer shaders above so the count matches the pixels they would draw.
+	**/
+	template<typename color_t> void shader_DepthQuery(const int32_t& offset, const int32_t& lx, const int32_t& ly,
+		const int32_t& dx1, const int32_t& dy1, int32_t O1, const RasterizerVec4& fP1,
+		const int32_t& dx2, const int32_t& dy2, int32_t O2, const RasterizerVec4& fP2,
+		const int32_t& dx3, const int32_t& dy3, int32_t O3, const RasterizerVec4& fP3,
+		const RasterizerParams<color_t, color_t>& data)
+		{
+		const float* zbuf = data.zbuf + offset;
+		const int32_t zstride = data.im->lx();
+		uint32_t count = 0;
+
+		const int32_t aera = O1 + O2 + O3;
+		const float invaera = 1.0f / aera;
+		const float fP1a = fP1.w * invaera;
+		const float fP2a = fP2.w * invaera;
+		const float fP3a = fP3.w * invaera;
+		const float dw = (dx1 * fP1a) + (dx2 * fP2a) + (dx3 * fP3a);
+
+		for (int32_t y = 0; y < ly; y++)
+			{ // iterate over scanlines
+			int32_t bx = 0; // start offset
+			if (O1 < 0)
+				{
+				// we know that dx1 > 0					
+				bx = (-O1 + dx1 - 1) / dx1; // first index where it becomes positive
+				}
+			if (O2 < 0)
+				{
+				if (dx2 <= 0)
+					{
+					if (dy2 <= 0) break;
+					const int32_t by = (-O2 + dy2 - 1) / dy2;
+					O1 += (by * dy1);
+					O2 += (by * dy2);
+					O3 += (by * dy3);
+					zbuf += by * zstride;
+					y += by - 1;
+					continue;
+					}
+				bx = max(bx, ((-O2 + dx2 - 1) / dx2));
+				}
+			if (O3 < 0)
+				{
+				if (dx3 <= 0)
+					{
+					if (dy3 <= 0) break;
+					const int32_t by = (-O3 + dy3 - 1) / dy3;
+					O1 += (by * dy1);
+					O2 += (by * dy2);
+					O3 += (by * dy3);
+					zbuf += by * zstride;
+					y += by - 1;
+					continue;
+					}
+				bx = max(bx, ((-O3 + dx3 - 1) / dx3));
+				}
+
+			const int32_t C1 = O1 + (dx1 * bx);
+			int32_t C2 = O2 + (dx2 * bx);
+			int32_t C3 = O3 + (dx3 * bx);
+			float cw = ((C1 * fP1a) + (C2 * fP2a) + (C3 * fP3a));
+
+			while ((bx < lx) && ((C2 | C3) >= 0))
+				{
+				if (zbuf[bx] < cw) count++;
+				C2 += dx2;
+				C3 += dx3;
+				cw += dw;
+				bx++;
+				}
+
+			O1 += dy1;
+			O2 += dy2;
+			O3 += dy3;
+			zbuf += zstride;
+			}
+		*data.query_count += count;
+		}
+
+
+
+
+	/**
+	* Size of the square blocks used by the block rasterizer (must be a power of two).
+	**/
+	#define TGX_SHADER_BLOCK_SIZE (8)
+
+
+	/**
+	* Block traversal of the triangle coverage used by shader_Blocks() below.
+	*
+	* The region [0,lx[x[0,ly[ is split into 8x8 blocks which are tested against the three edge
+	* functions using their corners: blocks completely outside of the triangle are skipped, blocks
+	* completely inside are accepted without any per-pixel test and only partially covered blocks
+	* are tested pixel by pixel. No division is performed.
+	*
+	* For each scanline y intersecting the triangle, span(y, bx, ex, C1, C2, C3) is called where
+	* [bx, ex[ is the (non-empty) interval of covered pixels on the scanline and C1, C2, C3 are the
+	* values of the edge functions at pixel bx.
+	**/
+	template<typename SPAN_FUNCTOR>
+	void rasterizeBlocks(const int32_t lx, const int32_t ly,
+		const int32_t dx1, const int32_t dy1, const int32_t O1,
+		const int32_t dx2, const int32_t dy2, const int32_t O2,
+		const int32_t dx3, const int32_t dy3, const int32_t O3,
+		const SPAN_FUNCTOR & span)
+		{
+		const int32_t B = TGX_SHADER_BLOCK_SIZE;
+
+		// offsets between the value of an edge function at the top left corner of a block
+		// and its minimum/maximum value on the block.
+		const int32_t mn1 = (min(dx1, 0) + min(dy1, 0)) * (B - 1);
+		const int32_t mn2 = (min(dx2, 0) + min(dy2, 0)) * (B - 1);
+		const int32_t mn3 = (min(dx3, 0) + min(dy3, 0)) * (B - 1);
+		const int32_t mx1 = (max(dx1, 0) + max(dy1, 0)) * (B - 1);
+		const int32_t mx2 = (max(dx2, 0) + max(dy2, 0)) * (B - 1);
+		const int32_t mx3 = (max(dx3, 0) + max(dy3, 0)) * (B - 1);
+
+		int32_t R1 = O1; // value of the edge functions
+		int32_t R2 = O2; // at the beginning of the
+		int32_t R3 = O3; // current band of blocks.
+
+		for (int32_t y0 = 0; y0 < ly; y0 += B)
+			{ // iterate over bands of blocks
+
+			// the blocks intersecting the triangle form an interval [xs, xe[ 
+			// and those fully inside the triangle form a sub-interval [fs, fe[ 
+			int32_t xs = -1, xe = -1;
+			int32_t fs = -1, fe = -1;
+			int32_t E1 = R1;
+			int32_t E2 = R2;
+			int32_t E3 = R3;
+			for (int32_t x0 = 0; x0 < lx; x0 += B)
+				{
+				if (((E1 + mx1) | (E2 + mx2) | (E3 + mx3)) < 0)
+					{ // trivial reject
+					if (xs >= 0) break;
+					}
+				else
+					{
+					if (xs < 0) xs = x0;
+					xe = x0 + B;
+					if (((E1 + mn1) | (E2 + mn2) | (E3 + mn3)) >= 0)
+						{ // trivial accept
+						if (fs < 0) fs = x0;
+						fe = x0 + B;
+						}
+					}
+				E1 += dx1 * B;
+				E2 += dx2 * B;
+				E3 += dx3 * B;
+				}
+
+			if (xs >= 0)
+				{
+				if (xe > lx) xe = lx;
+				if (fe > lx) fe = lx;
+				const int32_t ye = min(y0 + B, ly);
+
+				int32_t L1 = R1 + dx1 * xs; // value of the edge 
+				int32_t L2 = R2 + dx2 * xs; // functions at pixel
+				int32_t L3 = R3 + dx3 * xs; // (xs, y)
+
+				for (int32_t y = y0; y < ye; y++)
+					{ // iterate over the scanlines of the band
+					int32_t bx = xs;
+					int32_t C1 = L1;
+					int32_t C2 = L2;
+					int32_t C3 = L3;
+					int32_t ex;
+					if (fs >= 0)
+						{ // pixels in [fs, fe[ are covered: only test the partial blocks at both ends
+						while ((bx < fs) && ((C1 | C2 | C3) < 0)) { bx++; C1 += dx1; C2 += dx2; C3 += dx3; }
+						ex = xe;
+						int32_t D1 = L1 + dx1 * (xe - 1 - xs);
+						int32_t D2 = L2 + dx2 * (xe - 1 - xs);
+						int32_t D3 = L3 + dx3 * (xe - 1 - xs);
+						while ((ex > fe) && ((D1 | D2 | D3) < 0)) { ex--; D1 -= dx1; D2 -= dx2; D3 -= dx3; }
+						}
+					else
+						{ // only partial blocks: test every pixel until the end of the span
+						while ((bx < xe) && ((C1 | C2 | C3) < 0)) { bx++; C1 += dx1; C2 += dx2; C3 += dx3; }
+						ex = bx;
+						int32_t D1 = C1;
+						int32_t D2 = C2;
+						int32_t D3 = C3;
+						while ((ex < xe) && ((D1 | D2 | D3) >= 0)) { ex++; D1 += dx1; D2 += dx2; D3 += dx3; }
+						}
+					if (bx < ex) span(y, bx, ex, C1, C2, C3);
+					L1 += dy1;
+					L2 += dy2;
+					L3 += dy3;
+					}
+				}
+
+			R1 += dy1 * B;
+			R2 += dy2 * B;
+			R3 += dy3 * B;
+			}
+		}
+
+
+	/**
+	* Span functor used with rasterizeBlocks(): shades a covered span of a scanline.
+	*
+	* Performs the same computations as the corresponding scanline shaders above
+	* (hence gives exactly the same result) but does not test the edge functions.
+	**/
+	template<typename color_t, bool ZBUFFER, bool ORTHO, bool GOURAUD, bool TEXTURE, bool TEXTURE_BILINEAR>
+	struct _BlockSpan3D
+		{
+
+		// true if the interpolated 1/z (or 2-z) value is needed.
+		static const bool USE_W = (ZBUFFER) || ((TEXTURE) && (!ORTHO));
+
+		color_t* buf;
+		float* zbuf;
+		int32_t stride, zstride;
+		int32_t dx2, dx3;
+		int32_t aera;
+
+		float fP1a, fP2a, fP3a, dw;
+
+		color_t col, col1, col2, col3;
+
+		int fPR, fPG, fPB;
+		int fP1R, fP1G, fP1B;
+		int fP21R, fP21G, fP21B;
+		int fP31R, fP31G, fP31B;
+
+		fVec2 T1, T2, T3;
+		float dtx, dty;
+		const color_t* tex;
+		int32_t texsize_x_mm, texsize_y_mm, texstride;
+
+
+		_BlockSpan3D(const int32_t offset,
+			const int32_t dx1, const int32_t O1, const RasterizerVec4& fP1,
+			const int32_t _dx2, const int32_t O2, const RasterizerVec4& fP2,
+			const int32_t _dx3, const int32_t O3, const RasterizerVec4& fP3,
+			const RasterizerParams<color_t, color_t>& data)
+			{
+			buf = data.im->data() + offset;
+			zbuf = (ZBUFFER) ? (data.zbuf + offset) : nullptr;
+			stride = data.im->stride();
+			zstride = data.im->lx();
+			dx2 = _dx2;
+			dx3 = _dx3;
+			aera = O1 + O2 + O3;
+
+			const float invaera = 1.0f / aera;
+			if (USE_W)
+				{
+				fP1a = fP1.w * invaera;
+				fP2a = fP2.w * invaera;
+				fP3a = fP3.w * invaera;
+				dw = (dx1 * fP1a) + (dx2 * fP2a) + (dx3 * fP3a);
+				}
+
+			if (!(TEXTURE))
+				{
+				if (GOURAUD)
+					{
+					col1 = (color_t)fP1.color;
+					col2 = (color_t)fP2.color;
+					col3 = (color_t)fP3.color;
+					}
+				else
+					{
+					col = (color_t)data.facecolor;
+					}
+				return;
+				}
+
+			if (GOURAUD)
+				{
+				const RGBf& cf1 = (RGBf)fP1.color;
+				const RGBf& cf2 = (RGBf)fP2.color;
+				const RGBf& cf3 = (RGBf)fP3.color;
+				fP1R = (int)(256 * cf1.R);
+				fP1G = (int)(256 * cf1.G);
+				fP1B = (int)(256 * cf1.B);
+				fP21R = (int)(256 * (cf2.R - cf1.R));
+				fP21G = (int)(256 * (cf2.G - cf1.G));
+				fP21B = (int)(256 * (cf2.B - cf1.B));
+				fP31R = (int)(256 * (cf3.R - cf1.R));
+				fP31G = (int)(256 * (cf3.G - cf1.G));
+				fP31B = (int)(256 * (cf3.B - cf1.B));
+				}
+			else
+				{
+				const RGBf& cf = (RGBf)data.facecolor;
+				fPR = (int)(256 * cf.R);
+				fPG = (int)(256 * cf.G);
+				fPB = (int)(256 * cf.B);
+				}
+
+			tex = data.tex->data();
+			const int32_t texsize_x = data.tex->width();
+			const int32_t texsize_y = data.tex->height();
+			texsize_x_mm = texsize_x - 1;
+			texsize_y_mm = texsize_y - 1;
+			texstride = data.tex->stride();
+
+			// divide the texture coord by z * aera (or just by aera for orthographic projection)
+			T1 = fP1.T;
+			T2 = fP2.T;
+			T3 = fP3.T;
+			if (ORTHO)
+				{
+				T1 *= invaera;
+				T2 *= invaera;
+				T3 *= invaera;
+				}
+			else
+				{
+				T1 *= fP1a;
+				T2 *= fP2a;
+				T3 *= fP3a;
+				}
+			T1.x *= texsize_x;
+			T2.x *= texsize_x;
+			T3.x *= texsize_x;
+			T1.y *= texsize_y;
+			T2.y *= texsize_y;
+			T3.y *= texsize_y;
+
+			dtx = ((T1.x * dx1) + (T2.x * dx2) + (T3.x * dx3));
+			dty = ((T1.y * dx1) + (T2.y * dx2) + (T3.y * dx3));
+			}
+
+
+		TGX_INLINE inline void operator()(const int32_t y, int32_t bx, const int32_t ex, const int32_t C1, int32_t C2, int32_t C3) const
+			{
+			// local copies so that the compiler does not reload them after each write in the image.
+			color_t* const row = buf + (y * stride);
+			float* const zrow = (ZBUFFER) ? (zbuf + (y * zstride)) : nullptr;
+			const int32_t ldx2 = dx2;
+			const int32_t ldx3 = dx3;
+			const int32_t laera = aera;
+			const float ldw = dw;
+			const float ldtx = dtx;
+			const float ldty = dty;
+
+			float cw = 0, tx = 0, ty = 0;
+			if (USE_W) cw = ((C1 * fP1a) + (C2 * fP2a) + (C3 * fP3a));
+			if (TEXTURE)
+				{
+				tx = ((T1.x * C1) + (T2.x * C2) + (T3.x * C3));
+				ty = ((T1.y * C1) + (T2.y * C2) + (T3.y * C3));
+				}
+
+			if ((!TEXTURE) && (!GOURAUD))
+				{ // flat shading
+				const color_t c = col;
+#if (TGX_SIMD)
+				if (ZBUFFER) bx += simdFillZbuffer(row + bx, zrow + bx, c, ex - bx, cw, ldw);
+				else bx += simdFill(row + bx, c, ex - bx);
+#endif
+				if (ZBUFFER)
+					{
+					while (bx < ex)
+						{
+						float& W = zrow[bx];
+						if (W < cw) { W = cw; row[bx] = c; }
+						cw += ldw;
+						bx++;
+						}
+					}
+				else
+					{
+					while (bx < ex) { row[bx++] = c; }
+					}
+				return;
+				}
+
+			if (!TEXTURE)
+				{ // gouraud shading
+				const color_t c1 = col1;
+				const color_t c2 = col2;
+				const color_t c3 = col3;
+#if (TGX_SIMD)
+				{ // vector kernel for the beginning of the span (host builds)
+				const int32_t k = simdGouraud<ZBUFFER>(row + bx, (ZBUFFER) ? (zrow + bx) : nullptr, ex - bx, C2, ldx2, C3, ldx3, laera, c1, c2, c3, cw, ldw);
+				bx += k; C2 += k * ldx2; C3 += k * ldx3;
+				}
+#endif
+				while (bx < ex)
+					{
+					if ((!ZBUFFER) || (zrow[bx] < cw))
+						{
+						if (ZBUFFER) zrow[bx] = cw;
+						row[bx] = interpolateColorsTriangle(c2, C2, c3, C3, c1, laera);
+						}
+					C2 += ldx2;
+					C3 += ldx3;
+					if (ZBUFFER) cw += ldw;
+					bx++;
+					}
+				return;
+				}
+
+			// texture mapping
+			const color_t* const ltex = tex;
+			const int32_t ltexsize_x_mm = texsize_x_mm;
+			const int32_t ltexsize_y_mm = texsize_y_mm;
+			const int32_t ltexstride = texstride;
+			while (bx < ex)
+				{
+				if ((!ZBUFFER) || (zrow[bx] < cw))
+					{
+					if (ZBUFFER) zrow[bx] = cw;
+					color_t c;
+					const float icw = (ORTHO) ? 1.0f : (1.0f / cw);
+					if (TEXTURE_BILINEAR)
+						{
+						const float xx = (ORTHO) ? tx : (tx * icw);
+						const float yy = (ORTHO) ? ty : (ty * icw);
+						const int ttx = (int)floorf(xx);
+						const int tty = (int)floorf(yy);
+						const float ax = xx - ttx;
+						const float ay = yy - tty;
+						const int minx = ttx & (ltexsize_x_mm);
+						const int maxx = (ttx + 1) & (ltexsize_x_mm);
+						const int miny = (tty & (ltexsize_y_mm)) * ltexstride;
+						const int maxy = ((tty + 1) & (ltexsize_y_mm)) * ltexstride;
+						c = interpolateColorsBilinear(ltex[minx + miny], ltex[maxx + miny], ltex[minx + maxy], ltex[maxx + maxy], ax, ay);
+						}
+					else
+						{
+						const int ttx = ((int)((ORTHO) ? tx : (tx * icw))) & (ltexsize_x_mm);
+						const int tty = ((int)((ORTHO) ? ty : (ty * icw))) & (ltexsize_y_mm);
+						c = ltex[ttx + (tty)*ltexstride];
+						}
+					if (GOURAUD)
+						{
+						const int r = fP1R + ((C2 * fP21R + C3 * fP31R) / laera);
+						const int g = fP1G + ((C2 * fP21G + C3 * fP31G) / laera);
+						const int b = fP1B + ((C2 * fP21B + C3 * fP31B) / laera);
+						c.mult256(r, g, b);
+						}
+					else
+						{
+						c.mult256(fPR, fPG, fPB);
+						}
+					row[bx] = c;
+					}
+				if (GOURAUD)
+					{
+					C2 += ldx2;
+					C3 += ldx3;
+					}
+				if (USE_W) cw += ldw;
+				tx += ldtx;
+				ty += ldty;
+				bx++;
+				}
+			}
+
+		};
+
+
+	/**
+	* BLOCK RASTERIZATION (ALL 3D SHADER TYPES)
+	*
+	* Same result as the corresponding scanline shader but the triangle is traversed by 8x8 blocks
+	* with rasterizeBlocks(). This is faster for large triangles since the interior of the triangle
+	* is drawn without any coverage test (but may be slightly slower for very small triangles).
+	**/
+	template<typename color_t, bool ZBUFFER, bool ORTHO, bool GOURAUD, bool TEXTURE, bool TEXTURE_BILINEAR>
+	void shader_Blocks(const int32_t& offset, const int32_t& lx, const int32_t& ly,
+		const int32_t dx1, const int32_t dy1, int32_t O1, const RasterizerVec4& fP1,
+		const int32_t dx2, const int32_t dy2, int32_t O2, const RasterizerVec4& fP2,
+		const int32_t dx3, const int32_t dy3, int32_t O3, const RasterizerVec4& fP3,
+		const RasterizerParams<color_t, color_t>& data)
+		{
+		_BlockSpan3D<color_t, ZBUFFER, ORTHO, GOURAUD, TEXTURE, TEXTURE_BILINEAR> span(offset, dx1, O1, fP1, dx2, O2, fP2, dx3, O3, fP3, data);
+		rasterizeBlocks(lx, ly, dx1, dy1, O1, dx2, dy2, O2, dx3, dy3, O3, span);
+		}
+
+
+	/**
+	* META-SHADER THAT DISPATCH TO THE CORRECT BLOCK SHADER.
+	**/
+	template<bool ZBUFFER, bool ORTHO, typename color_t> void shader_select_Blocks(const int32_t& offset, const int32_t& lx, const int32_t& ly,
+		const int32_t dx1, const int32_t dy1, int32_t O1, const RasterizerVec4& fP1,
+		const int32_t dx2, const int32_t dy2, int32_t O2, const RasterizerVec4& fP2,
+		const int32_t dx3, const int32_t dy3, int32_t O3, const RasterizerVec4& fP3,
+		const RasterizerParams<color_t, color_t> & data)
+		{
+		int raster_type = data.shader_type;
+		if (TGX_SHADER_HAS_TEXTURE(raster_type))
+			{
+			if (TGX_SHADER_HAS_GOURAUD(raster_type))
+				{
+				if (data.use_bilinear_texturing)
+					shader_Blocks<color_t, ZBUFFER, ORTHO, true, true, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+				else
+					shader_Blocks<color_t, ZBUFFER, ORTHO, true, true, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+				}
+			else
+				{
+				if (data.use_bilinear_texturing)
+					shader_Blocks<color_t, ZBUFFER, ORTHO, false, true, true>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+				else
+					shader_Blocks<color_t, ZBUFFER, ORTHO, false, true, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+				}
+			}
+		else
+			{
+			if (TGX_SHADER_HAS_GOURAUD(raster_type))
+				shader_Blocks<color_t, ZBUFFER, ORTHO, true, false, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+			else
+				shader_Blocks<color_t, ZBUFFER, ORTHO, false, false, false>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+			}
+		}
+
+
+
 	/**
 	* META-SHADER THAT DISPATCH TO THE CORRECT SHADER ABOVE.
 	**/
@@ -1649,6 +2217,11 @@ namespace tgx
 		const int32_t dx3, const int32_t dy3, int32_t O3, const RasterizerVec4& fP3,
 		const RasterizerParams<color_t, color_t> & data)
 		{		
+		if (data.use_block_rasterization)
+			{ // USING BLOCK TRAVERSAL
+			shader_select_Blocks<ZBUFFER, ORTHO, color_t>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+			return;
+			}
 		int raster_type = data.shader_type;       
 		if (ZBUFFER)
 			{ // USING ZBUFFER
@@ -1774,6 +2347,77 @@ namespace tgx
 
 
 
+	/**
+	* SHADER RESOLVED AT COMPILE TIME.
+	*
+	* Same as shader_select() but the shader type (RASTER_TYPE), the texture sampling mode and
+	* the traversal mode are template parameters. An instance of this (empty) class is passed as
+	* the shader function to the rasterizer which then calls the correct shader directly, without
+	* the per-triangle runtime dispatch (data.shader_type, data.use_bilinear_texturing and
+	* data.use_block_rasterization are ignored).
+	**/
+	template<bool ZBUFFER, bool ORTHO, int RASTER_TYPE, bool TEXTURE_BILINEAR, bool BLOCKS, typename color_t> struct ShaderFixed
+		{
+		inline void operator()(const int32_t& offset, const int32_t& lx, const int32_t& ly,
+			const int32_t dx1, const int32_t dy1, int32_t O1, const RasterizerVec4& fP1,
+			const int32_t dx2, const int32_t dy2, int32_t O2, const RasterizerVec4& fP2,
+			const int32_t dx3, const int32_t dy3, int32_t O3, const RasterizerVec4& fP3,
+			const RasterizerParams<color_t, color_t>& data) const
+			{
+			static const bool TEXTURE = (bool)(TGX_SHADER_HAS_TEXTURE(RASTER_TYPE));
+			static const bool GOURAUD = (bool)(TGX_SHADER_HAS_GOURAUD(RASTER_TYPE));
+			if (BLOCKS)
+				{
+				shader_Blocks<color_t, ZBUFFER, ORTHO, GOURAUD, TEXTURE, TEXTURE_BILINEAR>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+				}
+			else if (TEXTURE)
+				{
+				if (ZBUFFER)
+					{
+					if (ORTHO)
+						{
+						if (GOURAUD) shader_Gouraud_Texture_Zbuffer_Ortho<color_t, TEXTURE_BILINEAR>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+						else shader_Flat_Texture_Zbuffer_Ortho<color_t, TEXTURE_BILINEAR>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+						}
+					else
+						{
+						if (GOURAUD) shader_Gouraud_Texture_Zbuffer<color_t, TEXTURE_BILINEAR>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+						else shader_Flat_Texture_Zbuffer<color_t, TEXTURE_BILINEAR>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+						}
+					}
+				else
+					{
+					if (ORTHO)
+						{
+						if (GOURAUD) shader_Gouraud_Texture_Ortho<color_t, TEXTURE_BILINEAR>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+						else shader_Flat_Texture_Ortho<color_t, TEXTURE_BILINEAR>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+						}
+					else
+						{
+						if (GOURAUD) shader_Gouraud_Texture<color_t, TEXTURE_BILINEAR>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+						else shader_Flat_Texture<color_t, TEXTURE_BILINEAR>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+						}
+					}
+				}
+			else
+				{ // same shaders for perspective and orthographic projection
+				if (ZBUFFER)
+					{
+					if (GOURAUD) shader_Gouraud_Zbuffer<color_t>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+					else shader_Flat_Zbuffer<color_t>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+					}
+				else
+					{
+					if (GOURAUD) shader_Gouraud<color_t>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+					else shader_Flat<color_t>(offset, lx, ly, dx1, dy1, O1, fP1, dx2, dy2, O2, fP2, dx3, dy3, O3, fP3, data);
+					}
+				}
+			}
+		};
+
+
+
+
 	inline TGX_INLINE int shaderclip(int v, int minv, int maxv)
 		{
 		return ((v < minv) ? minv : ((v > maxv) ? maxv : v));
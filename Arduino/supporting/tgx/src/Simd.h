@@ -0,0 +1,448 @@
+/** @file Simd.h */
+//
+// Copyright 2020 Arvind Singh
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+//version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _TGX_SIMD_H_
+#define _TGX_SIMD_H_
+
+// only C++, no plain C
+#ifdef __cplusplus
+
+
+#include "Misc.h"
+#include "Color.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+
+/* Instruction sets for the vector span kernels below. */
+#define TGX_SIMD_NONE   0   // scalar code only (always the case on MCUs)
+#define TGX_SIMD_SSE2   1   // x86 / x86-64 with SSE2 (8 RGB565 pixels at a time)
+#define TGX_SIMD_AVX2   2   // x86-64 with AVX2 (16 RGB565 pixels at a time)
+#define TGX_SIMD_NEON   3   // ARM with NEON (8 RGB565 pixels at a time)
+
+/* The instruction set is selected at compile time from the compiler flags (for example
+   -mavx2 or -march=native for AVX2). Define TGX_SIMD to TGX_SIMD_NONE before including
+   tgx.h to force the scalar code on a host build. */
+#ifndef TGX_SIMD
+    #if defined(TGX_ON_ARDUINO)
+        #define TGX_SIMD TGX_SIMD_NONE
+    #elif defined(__AVX2__)
+        #define TGX_SIMD TGX_SIMD_AVX2
+    #elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+        #define TGX_SIMD TGX_SIMD_SSE2
+    #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        #define TGX_SIMD TGX_SIMD_NEON
+    #else
+        #define TGX_SIMD TGX_SIMD_NONE
+    #endif
+#endif
+
+#if (TGX_SIMD == TGX_SIMD_AVX2)
+    #include <immintrin.h>
+#elif (TGX_SIMD == TGX_SIMD_SSE2)
+    #include <emmintrin.h>
+#elif (TGX_SIMD == TGX_SIMD_NEON)
+    #include <arm_neon.h>
+#endif
+
+
+#if (TGX_SIMD)
+
+namespace tgx
+{
+
+
+    /**
+    * Vector span kernels used by the shaders and by the Image class on host builds.
+    *
+    * Each kernel processes the first pixels of a span by groups of TGX_SIMD_N16 pixels and
+    * returns the number of pixels processed (a multiple of TGX_SIMD_N16, possibly 0 when the
+    * color type or the parameters are not supported). The caller completes the span with its
+    * scalar loop so the kernels give exactly the same result as the scalar code.
+    *
+    * Remark: when FMA is available (-march=native), the compiler may contract the float
+    * setup of a span differently in the two builds, so comparing a vector build against a
+    * TGX_SIMD_NONE build bit for bit requires -ffp-contract=off.
+    **/
+
+
+#if (TGX_SIMD == TGX_SIMD_AVX2)
+
+    #define TGX_SIMD_N16 16     // number of 16-bit lanes
+
+    typedef __m256i _simd_v16;
+
+    TGX_INLINE inline _simd_v16 _simd_load16(const uint16_t* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    TGX_INLINE inline void _simd_store16(uint16_t* p, _simd_v16 v) { _mm256_storeu_si256((__m256i*)p, v); }
+    TGX_INLINE inline _simd_v16 _simd_set16(uint16_t c) { return _mm256_set1_epi16((int16_t)c); }
+    TGX_INLINE inline _simd_v16 _simd_set32(uint32_t c) { return _mm256_set1_epi32((int32_t)c); }
+    TGX_INLINE inline _simd_v16 _simd_and(_simd_v16 a, _simd_v16 b) { return _mm256_and_si256(a, b); }
+    TGX_INLINE inline _simd_v16 _simd_or(_simd_v16 a, _simd_v16 b) { return _mm256_or_si256(a, b); }
+    TGX_INLINE inline _simd_v16 _simd_add16(_simd_v16 a, _simd_v16 b) { return _mm256_add_epi16(a, b); }
+    TGX_INLINE inline _simd_v16 _simd_sub16(_simd_v16 a, _simd_v16 b) { return _mm256_sub_epi16(a, b); }
+    TGX_INLINE inline _simd_v16 _simd_mul16(_simd_v16 a, _simd_v16 b) { return _mm256_mullo_epi16(a, b); }
+    TGX_INLINE inline _simd_v16 _simd_eq16(_simd_v16 a, _simd_v16 b) { return _mm256_cmpeq_epi16(a, b); }
+    TGX_INLINE inline _simd_v16 _simd_select(_simd_v16 m, _simd_v16 a, _simd_v16 b) { return _mm256_blendv_epi8(b, a, m); }
+    template<int N> TGX_INLINE inline _simd_v16 _simd_srl16(_simd_v16 v) { return _mm256_srli_epi16(v, N); }
+    template<int N> TGX_INLINE inline _simd_v16 _simd_sra16(_simd_v16 v) { return _mm256_srai_epi16(v, N); }
+    template<int N> TGX_INLINE inline _simd_v16 _simd_sll16(_simd_v16 v) { return _mm256_slli_epi16(v, N); }
+
+
+    /** floor((C + k*dx)*32 / aera) for k = 0..15 (requires 0 <= C + k*dx <= aera < 2^26) */
+    TGX_INLINE inline _simd_v16 _simd_weights(int32_t C, int32_t dx, int32_t aera, float invaera)
+        {
+        const __m256i A = _mm256_set1_epi32(aera);
+        const __m256i Am = _mm256_set1_epi32(aera - 1);
+        const __m256 inv = _mm256_set1_ps(invaera);
+        const __m256i D = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(dx));
+        __m256i q[2];
+        for (int i = 0; i < 2; i++)
+            {
+            const __m256i a = _mm256_slli_epi32(_mm256_add_epi32(_mm256_set1_epi32(C + 8 * i * dx), D), 5);
+            __m256i e = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(a), inv)); // off by at most one
+            const __m256i r = _mm256_sub_epi32(a, _mm256_mullo_epi32(e, A));
+            e = _mm256_add_epi32(e, _mm256_cmpgt_epi32(_mm256_setzero_si256(), r)); // r < 0 : e - 1
+            q[i] = _mm256_sub_epi32(e, _mm256_cmpgt_epi32(r, Am));                 // r >= aera : e + 1
+            }
+        return _mm256_permute4x64_epi64(_mm256_packs_epi32(q[0], q[1]), 0xD8);
+        }
+
+
+    /** next 8 depth values cw, cw + dw, ... with the same rounding as the scalar loop (cw is updated) */
+    TGX_INLINE inline __m256 _simd_ramp8(float& cw, float dw)
+        {
+        const float w0 = cw, w1 = w0 + dw, w2 = w1 + dw, w3 = w2 + dw, w4 = w3 + dw, w5 = w4 + dw, w6 = w5 + dw, w7 = w6 + dw;
+        cw = w7 + dw;
+        return _mm256_setr_ps(w0, w1, w2, w3, w4, w5, w6, w7);
+        }
+
+
+    /** depth test of 16 pixels at depths cw, cw + dw, ...: update zbuf where it is smaller and return the mask of these pixels (cw is updated) */
+    TGX_INLINE inline _simd_v16 _simd_depth(float* zbuf, float& cw, float dw)
+        {
+        __m256i m[2];
+        for (int i = 0; i < 2; i++)
+            {
+            const __m256 z = _mm256_loadu_ps(zbuf + 8 * i);
+            const __m256 w = _simd_ramp8(cw, dw);
+            const __m256 mf = _mm256_cmp_ps(z, w, _CMP_LT_OQ);
+            _mm256_storeu_ps(zbuf + 8 * i, _mm256_blendv_ps(z, w, mf));
+            m[i] = _mm256_castps_si256(mf);
+            }
+        return _mm256_permute4x64_epi64(_mm256_packs_epi32(m[0], m[1]), 0xD8);
+        }
+
+
+#elif (TGX_SIMD == TGX_SIMD_SSE2)
+
+    #define TGX_SIMD_N16 8      // number of 16-bit lanes
+
+    typedef __m128i _simd_v16;
+
+    TGX_INLINE inline _simd_v16 _simd_load16(const uint16_t* p) { return _mm_loadu_si128((const __m128i*)p); }
+    TGX_INLINE inline void _simd_store16(uint16_t* p, _simd_v16 v) { _mm_storeu_si128((__m128i*)p, v); }
+    TGX_INLINE inline _simd_v16 _simd_set16(uint16_t c) { return _mm_set1_epi16((int16_t)c); }
+    TGX_INLINE inline _simd_v16 _simd_set32(uint32_t c) { return _mm_set1_epi32((int32_t)c); }
+    TGX_INLINE inline _simd_v16 _simd_and(_simd_v16 a, _simd_v16 b) { return _mm_and_si128(a, b); }
+    TGX_INLINE inline _simd_v16 _simd_or(_simd_v16 a, _simd_v16 b) { return _mm_or_si128(a, b); }
+    TGX_INLINE inline _simd_v16 _simd_add16(_simd_v16 a, _simd_v16 b) { return _mm_add_epi16(a, b); }
+    TGX_INLINE inline _simd_v16 _simd_sub16(_simd_v16 a, _simd_v16 b) { return _mm_sub_epi16(a, b); }
+    TGX_INLINE inline _simd_v16 _simd_mul16(_simd_v16 a, _simd_v16 b) { return _mm_mullo_epi16(a, b); }
+    TGX_INLINE inline _simd_v16 _simd_eq16(_simd_v16 a, _simd_v16 b) { return _mm_cmpeq_epi16(a, b); }
+    TGX_INLINE inline _simd_v16 _simd_select(_simd_v16 m, _simd_v16 a, _simd_v16 b) { return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b)); }
+    template<int N> TGX_INLINE inline _simd_v16 _simd_srl16(_simd_v16 v) { return _mm_srli_epi16(v, N); }
+    template<int N> TGX_INLINE inline _simd_v16 _simd_sra16(_simd_v16 v) { return _mm_srai_epi16(v, N); }
+    template<int N> TGX_INLINE inline _simd_v16 _simd_sll16(_simd_v16 v) { return _mm_slli_epi16(v, N); }
+
+
+    /** low 32 bits of a*b for each lane (SSE2 has no 32-bit mullo) */
+    TGX_INLINE inline __m128i _simd_mul32(__m128i a, __m128i b)
+        {
+        const __m128i p02 = _mm_mul_epu32(a, b);
+        const __m128i p13 = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(p02, 0x08), _mm_shuffle_epi32(p13, 0x08));
+        }
+
+
+    /** floor((C + k*dx)*32 / aera) for k = 0..7 (requires 0 <= C + k*dx <= aera < 2^26) */
+    TGX_INLINE inline _simd_v16 _simd_weights(int32_t C, int32_t dx, int32_t aera, float invaera)
+        {
+        const __m128i A = _mm_set1_epi32(aera);
+        const __m128i Am = _mm_set1_epi32(aera - 1);
+        const __m128 inv = _mm_set1_ps(invaera);
+        const __m128i D = _mm_setr_epi32(0, dx, 2 * dx, 3 * dx);
+        __m128i q[2];
+        for (int i = 0; i < 2; i++)
+            {
+            const __m128i a = _mm_slli_epi32(_mm_add_epi32(_mm_set1_epi32(C + 4 * i * dx), D), 5);
+            __m128i e = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(a), inv)); // off by at most one
+            const __m128i r = _mm_sub_epi32(a, _simd_mul32(e, A));
+            e = _mm_add_epi32(e, _mm_cmplt_epi32(r, _mm_setzero_si128())); // r < 0 : e - 1
+            q[i] = _mm_sub_epi32(e, _mm_cmpgt_epi32(r, Am));                // r >= aera : e + 1
+            }
+        return _mm_packs_epi32(q[0], q[1]);
+        }
+
+
+    /** next 4 depth values cw, cw + dw, ... with the same rounding as the scalar loop (cw is updated) */
+    TGX_INLINE inline __m128 _simd_ramp4(float& cw, float dw)
+        {
+        const float w0 = cw, w1 = w0 + dw, w2 = w1 + dw, w3 = w2 + dw;
+        cw = w3 + dw;
+        return _mm_setr_ps(w0, w1, w2, w3);
+        }
+
+
+    /** depth test of 8 pixels at depths cw, cw + dw, ...: update zbuf where it is smaller and return the mask of these pixels (cw is updated) */
+    TGX_INLINE inline _simd_v16 _simd_depth(float* zbuf, float& cw, float dw)
+        {
+        __m128i m[2];
+        for (int i = 0; i < 2; i++)
+            {
+            const __m128 z = _mm_loadu_ps(zbuf + 4 * i);
+            const __m128 w = _simd_ramp4(cw, dw);
+            const __m128 mf = _mm_cmplt_ps(z, w);
+            _mm_storeu_ps(zbuf + 4 * i, _mm_or_ps(_mm_and_ps(mf, w), _mm_andnot_ps(mf, z)));
+            m[i] = _mm_castps_si128(mf);
+            }
+        return _mm_packs_epi32(m[0], m[1]);
+        }
+
+
+#elif (TGX_SIMD == TGX_SIMD_NEON)
+
+    #define TGX_SIMD_N16 8      // number of 16-bit lanes
+
+    typedef uint16x8_t _simd_v16;
+
+    TGX_INLINE inline _simd_v16 _simd_load16(const uint16_t* p) { return vld1q_u16(p); }
+    TGX_INLINE inline void _simd_store16(uint16_t* p, _simd_v16 v) { vst1q_u16(p, v); }
+    TGX_INLINE inline _simd_v16 _simd_set16(uint16_t c) { return vdupq_n_u16(c); }
+    TGX_INLINE inline _simd_v16 _simd_set32(uint32_t c) { return vreinterpretq_u16_u32(vdupq_n_u32(c)); }
+    TGX_INLINE inline _simd_v16 _simd_and(_simd_v16 a, _simd_v16 b) { return vandq_u16(a, b); }
+    TGX_INLINE inline _simd_v16 _simd_or(_simd_v16 a, _simd_v16 b) { return vorrq_u16(a, b); }
+    TGX_INLINE inline _simd_v16 _simd_add16(_simd_v16 a, _simd_v16 b) { return vaddq_u16(a, b); }
+    TGX_INLINE inline _simd_v16 _simd_sub16(_simd_v16 a, _simd_v16 b) { return vsubq_u16(a, b); }
+    TGX_INLINE inline _simd_v16 _simd_mul16(_simd_v16 a, _simd_v16 b) { return vmulq_u16(a, b); }
+    TGX_INLINE inline _simd_v16 _simd_eq16(_simd_v16 a, _simd_v16 b) { return vceqq_u16(a, b); }
+    TGX_INLINE inline _simd_v16 _simd_select(_simd_v16 m, _simd_v16 a, _simd_v16 b) { return vbslq_u16(m, a, b); }
+    template<int N> TGX_INLINE inline _simd_v16 _simd_srl16(_simd_v16 v) { return vshrq_n_u16(v, N); }
+    template<int N> TGX_INLINE inline _simd_v16 _simd_sra16(_simd_v16 v) { return vreinterpretq_u16_s16(vshrq_n_s16(vreinterpretq_s16_u16(v), N)); }
+    template<int N> TGX_INLINE inline _simd_v16 _simd_sll16(_simd_v16 v) { return vshlq_n_u16(v, N); }
+
+
+    /** floor((C + k*dx)*32 / aera) for k = 0..7 (requires 0 <= C + k*dx <= aera < 2^26) */
+    TGX_INLINE inline _simd_v16 _simd_weights(int32_t C, int32_t dx, int32_t aera, float invaera)
+        {
+        const int32x4_t A = vdupq_n_s32(aera);
+        const int32_t d[4] = { 0, dx, 2 * dx, 3 * dx };
+        const int32x4_t D = vld1q_s32(d);
+        int16x4_t q[2];
+        for (int i = 0; i < 2; i++)
+            {
+            const int32x4_t a = vshlq_n_s32(vaddq_s32(vdupq_n_s32(C + 4 * i * dx), D), 5);
+            int32x4_t e = vcvtq_s32_f32(vmulq_n_f32(vcvtq_f32_s32(a), invaera)); // off by at most one
+            const int32x4_t r = vsubq_s32(a, vmulq_s32(e, A));
+            e = vaddq_s32(e, vreinterpretq_s32_u32(vcltq_s32(r, vdupq_n_s32(0)))); // r < 0 : e - 1
+            e = vsubq_s32(e, vreinterpretq_s32_u32(vcgeq_s32(r, A)));              // r >= aera : e + 1
+            q[i] = vmovn_s32(e);
+            }
+        return vreinterpretq_u16_s16(vcombine_s16(q[0], q[1]));
+        }
+
+
+    /** next 4 depth values cw, cw + dw, ... with the same rounding as the scalar loop (cw is updated) */
+    TGX_INLINE inline float32x4_t _simd_ramp4(float& cw, float dw)
+        {
+        const float w0 = cw, w1 = w0 + dw, w2 = w1 + dw, w3 = w2 + dw;
+        cw = w3 + dw;
+        const float w[4] = { w0, w1, w2, w3 };
+        return vld1q_f32(w);
+        }
+
+
+    /** depth test of 8 pixels at depths cw, cw + dw, ...: update zbuf where it is smaller and return the mask of these pixels (cw is updated) */
+    TGX_INLINE inline _simd_v16 _simd_depth(float* zbuf, float& cw, float dw)
+        {
+        uint16x4_t m[2];
+        for (int i = 0; i < 2; i++)
+            {
+            const float32x4_t z = vld1q_f32(zbuf + 4 * i);
+            const float32x4_t w = _simd_ramp4(cw, dw);
+            const uint32x4_t mf = vcltq_f32(z, w);
+            vst1q_f32(zbuf + 4 * i, vbslq_f32(mf, w, z));
+            m[i] = vmovn_u32(mf);
+            }
+        return vcombine_u16(m[0], m[1]);
+        }
+
+
+#endif
+
+
+    /**
+    * Alpha-blend fg over bg with opacity a in [0,32] (i.e. alpha256 >> 3) for each RGB565
+    * lane. Same result as RGB565::blend256().
+    **/
+    TGX_INLINE inline _simd_v16 _simd_blend565(_simd_v16 bg, _simd_v16 fg, _simd_v16 a)
+        {
+        const _simd_v16 m5 = _simd_set16(0x1F);
+        const _simd_v16 m6 = _simd_set16(0x3F);
+        const _simd_v16 bB = _simd_and(bg, m5);
+        const _simd_v16 bG = _simd_and(_simd_srl16<5>(bg), m6);
+        const _simd_v16 bR = _simd_srl16<11>(bg);
+        const _simd_v16 B = _simd_add16(_simd_sra16<5>(_simd_mul16(_simd_sub16(_simd_and(fg, m5), bB), a)), bB);
+        const _simd_v16 G = _simd_add16(_simd_sra16<5>(_simd_mul16(_simd_sub16(_simd_and(_simd_srl16<5>(fg), m6), bG), a)), bG);
+        const _simd_v16 R = _simd_add16(_simd_sra16<5>(_simd_mul16(_simd_sub16(_simd_srl16<11>(fg), bR), a)), bR);
+        return _simd_or(B, _simd_or(_simd_sll16<5>(G), _simd_sll16<11>(R)));
+        }
+
+
+    /**
+    * Fill the first pixels of p[0..n-1] with color c. Only for 2 and 4 bytes color types
+    * (RGB565, RGB32), returns 0 otherwise.
+    **/
+    template<typename color_t> TGX_INLINE inline int32_t simdFill(color_t* p, color_t c, int32_t n)
+        {
+        if ((sizeof(color_t) != 2) && (sizeof(color_t) != 4)) return 0;
+        const int32_t N = TGX_SIMD_N16 * 2 / sizeof(color_t);
+        _simd_v16 v;
+        if (sizeof(color_t) == 2) { uint16_t c16; memcpy(&c16, &c, 2); v = _simd_set16(c16); }
+        else { uint32_t c32; memcpy(&c32, &c, sizeof(color_t)); v = _simd_set32(c32); }
+        int32_t k = 0;
+        for (; k + N <= n; k += N) _simd_store16((uint16_t*)(p + k), v);
+        return k;
+        }
+
+
+    /**
+    * Flat shading with depth test for the first pixels of p[0..n-1]: the depth of pixel k is
+    * the value of cw after k increments by dw and cw is updated accordingly. Only for 2 bytes
+    * color types (RGB565), returns 0 otherwise.
+    **/
+    template<typename color_t> TGX_INLINE inline int32_t simdFillZbuffer(color_t* p, float* zbuf, color_t c, int32_t n, float& cw, float dw)
+        {
+        if (sizeof(color_t) != 2) return 0;
+        uint16_t c16; memcpy(&c16, &c, 2);
+        const _simd_v16 v = _simd_set16(c16);
+        float lcw = cw;
+        int32_t k = 0;
+        for (; k + TGX_SIMD_N16 <= n; k += TGX_SIMD_N16)
+            {
+            uint16_t* q = (uint16_t*)(p + k);
+            _simd_store16(q, _simd_select(_simd_depth(zbuf + k, lcw, dw), v, _simd_load16(q)));
+            }
+        cw = lcw;
+        return k;
+        }
+
+
+    /**
+    * Gouraud shading (with depth test if ZBUFFER is set) for the first pixels of p[0..n-1].
+    * Computes interpolateColorsTriangle(col2, C2, col3, C3, col1, aera) with C2 and C3
+    * incremented by dx2 and dx3 at each pixel. Only for RGB565 and when aera < 2^26 (so that
+    * the weights are computed without overflow), returns 0 otherwise.
+    **/
+    template<bool ZBUFFER, typename color_t> TGX_INLINE inline int32_t simdGouraud(color_t* p, float* zbuf, int32_t n,
+                                                                                    int32_t C2, int32_t dx2, int32_t C3, int32_t dx3, int32_t aera,
+                                                                                    color_t col1, color_t col2, color_t col3, float& cw, float dw)
+        {
+        if ((!std::is_same<color_t, RGB565>::value) || (aera <= 0) || (aera >= (1 << 26))) return 0;
+        const uint16_t v1 = ((RGB565)col1).val;
+        const uint16_t v2 = ((RGB565)col2).val;
+        const uint16_t v3 = ((RGB565)col3).val;
+        const _simd_v16 c1B = _simd_set16(v1 & 0x1F), c1G = _simd_set16((v1 >> 5) & 0x3F), c1R = _simd_set16(v1 >> 11);
+        const _simd_v16 c2B = _simd_set16(v2 & 0x1F), c2G = _simd_set16((v2 >> 5) & 0x3F), c2R = _simd_set16(v2 >> 11);
+        const _simd_v16 c3B = _simd_set16(v3 & 0x1F), c3G = _simd_set16((v3 >> 5) & 0x3F), c3R = _simd_set16(v3 >> 11);
+        const _simd_v16 c32 = _simd_set16(32);
+        const float invaera = 1.0f / aera;
+        float lcw = cw;
+        int32_t k = 0;
+        for (; k + TGX_SIMD_N16 <= n; k += TGX_SIMD_N16)
+            {
+            const _simd_v16 q2 = _simd_weights(C2 + k * dx2, dx2, aera, invaera);
+            const _simd_v16 q3 = _simd_weights(C3 + k * dx3, dx3, aera, invaera);
+            const _simd_v16 q1 = _simd_sub16(_simd_sub16(c32, q2), q3);
+            // the three weights are non negative with sum 32: no carry between the channels.
+            const _simd_v16 B = _simd_srl16<5>(_simd_add16(_simd_add16(_simd_mul16(c1B, q1), _simd_mul16(c2B, q2)), _simd_mul16(c3B, q3)));
+            const _simd_v16 G = _simd_srl16<5>(_simd_add16(_simd_add16(_simd_mul16(c1G, q1), _simd_mul16(c2G, q2)), _simd_mul16(c3G, q3)));
+            const _simd_v16 R = _simd_srl16<5>(_simd_add16(_simd_add16(_simd_mul16(c1R, q1), _simd_mul16(c2R, q2)), _simd_mul16(c3R, q3)));
+            const _simd_v16 col = _simd_or(B, _simd_or(_simd_sll16<5>(G), _simd_sll16<11>(R)));
+            uint16_t* q = (uint16_t*)(p + k);
+            if (ZBUFFER)
+                {
+                _simd_store16(q, _simd_select(_simd_depth(zbuf + k, lcw, dw), col, _simd_load16(q)));
+                }
+            else
+                {
+                _simd_store16(q, col);
+                }
+            }
+        cw = lcw;
+        return k;
+        }
+
+
+    /**
+    * Blend color c with opacity op256 in [0,256] over the first pixels of the RGB565 row
+    * p[0..n-1]. Same result as RGB565::blend256().
+    **/
+    TGX_INLINE inline int32_t simdBlendFill565(uint16_t* p, uint16_t c, int32_t n, uint32_t op256)
+        {
+        const _simd_v16 a = _simd_set16((uint16_t)(op256 >> 3));
+        const _simd_v16 fg = _simd_set16(c);
+        int32_t k = 0;
+        for (; k + TGX_SIMD_N16 <= n; k += TGX_SIMD_N16) _simd_store16(p + k, _simd_blend565(_simd_load16(p + k), fg, a));
+        return k;
+        }
+
+
+    /**
+    * Blend the RGB565 row psrc over pdest with opacity op256 in [0,256], skipping the source
+    * pixels equal to transparent_color if USE_MASK is set. Processes the first pixels of
+    * the row, or the last ones if BACKWARD is set (for overlapping rows with pdest > psrc).
+    * Same result as RGB565::blend256().
+    **/
+    template<bool USE_MASK, bool BACKWARD> TGX_INLINE inline int32_t simdBlendRow565(uint16_t* pdest, const uint16_t* psrc, int32_t n, uint32_t op256, uint16_t transparent_color)
+        {
+        const _simd_v16 a = _simd_set16((uint16_t)(op256 >> 3));
+        const _simd_v16 tr = _simd_set16(transparent_color);
+        int32_t k = 0;
+        for (; k + TGX_SIMD_N16 <= n; k += TGX_SIMD_N16)
+            {
+            const int32_t i = (BACKWARD) ? (n - k - TGX_SIMD_N16) : k;
+            const _simd_v16 s = _simd_load16(psrc + i);
+            const _simd_v16 d = _simd_load16(pdest + i);
+            const _simd_v16 r = _simd_blend565(d, s, a);
+            _simd_store16(pdest + i, (USE_MASK) ? _simd_select(_simd_eq16(s, tr), d, r) : r);
+            }
+        return k;
+        }
+
+
+}
+
+#endif
+
+#endif
+
+#endif
+
+/** end of file **/
+
@@ -0,0 +1,363 @@
+/** @file TextureCache.h */
+//
+// Copyright 2020 Arvind Singh
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+//version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _TGX_TEXTURECACHE_H_
+#define _TGX_TEXTURECACHE_H_
+
+// only C++, no plain C
+#ifdef __cplusplus
+
+
+#include "Misc.h"
+#include "Color.h"
+#include "Image.h"
+
+#include <stdint.h>
+#include <string.h>
+
+
+namespace tgx
+{
+
+
+    /**
+    * Cache keeping the most recently used textures in fast memory.
+    *
+    * Each texture managed by the cache is identified by a 'key' image: the texture pointer
+    * stored in the meshes (Mesh3D::texture). The pixels of a texture come either from the
+    * key image itself (a texture in flash or in PSRAM) or from a user supplied callback (for
+    * example to read the texture from an SD card). When a texture is requested, a copy is
+    * made in memory if it is not already there and, if the budget is exceeded, the least
+    * recently used textures are evicted to make room for it.
+    *
+    * The cache is given to a renderer with Renderer3D::setTextureCache() and is then queried
+    * each time a textured mesh is drawn. Keys not registered with the cache are used as is.
+    *
+    * Example:
+    *
+    *   TextureCache<RGB565> cache(100000);          // 100KB budget in internal RAM
+    *   cache.addTexture(&body_texture);             // texture in flash, copied on first use
+    *   cache.addTexture(&head_texture, 128, 128, load_from_sd, (void*)"/head.raw");
+    *   renderer.setTextureCache(&cache);
+    *   ...
+    *   auto st = cache.getStats();                  // hits/misses to adjust the budget
+    *
+    * The cache is not thread safe: it must only be used from the rendering task.
+    **/
+    template<typename color_t> class TextureCache
+    {
+
+        // make sure right away that the template parameter is admissible to prevent cryptic error message later.
+        static_assert(is_color<color_t>::value, "color_t must be one of the color types defined in color.h");
+
+    public:
+
+        /** maximum number of textures managed by a cache */
+        static const int MAXTEXTURES = 32;
+
+
+        /**
+        * Callback used to load a texture: must write the lx*ly pixels (no padding between
+        * lines) in dst and return true on success.
+        **/
+        typedef bool (*LoadFunction)(void* ctx, color_t* dst, int lx, int ly);
+
+
+        /**
+        * Cache usage counters, accumulated since the last call to resetStats().
+        **/
+        struct Stats
+            {
+            uint32_t hits;          // requests for a texture already in memory
+            uint32_t misses;        // requests for a texture that had to be loaded
+            uint32_t evictions;     // textures evicted to make room for others
+            uint32_t failures;      // requests that could not be served from the cache (too large, out of memory, load error)
+            uint32_t bytes_loaded;  // total size of the textures loaded
+            };
+
+
+        /**
+        * Constructor.
+        *
+        * - budget : maximum number of bytes used by the textures in the cache.
+        * - use_extmem : true to allocate the textures in external RAM (PSRAM on ESP32,
+        *                EXTMEM on Teensy 4.1) and false to use internal RAM.
+        **/
+        TextureCache(size_t budget, bool use_extmem = false) : _budget(budget), _used(0), _extmem(use_extmem), _nb(0), _clock(0)
+            {
+            resetStats();
+            }
+
+
+        /**
+        * Destructor. Release all the textures.
+        **/
+        ~TextureCache()
+            {
+            clear();
+            }
+
+
+        /**
+        * Register a texture whose pixels are copied from the key image itself (texture in
+        * flash or in slow memory). Return false if the cache is full or the key is invalid.
+        **/
+        bool addTexture(const Image<color_t>* key)
+            {
+            if ((key == nullptr) || (!key->isValid())) return false;
+            return addTexture(key, key->lx(), key->ly(), nullptr, nullptr);
+            }
+
+
+        /**
+        * Register a texture of size lx x ly whose pixels are obtained by calling load(ctx, ...).
+        * The key is only used to identify the texture (it does not need to have a valid buffer
+        * but, if it does, it is used directly when the texture cannot be loaded in the cache).
+        * Return false if the cache is full.
+        **/
+        bool addTexture(const Image<color_t>* key, int lx, int ly, LoadFunction load, void* ctx)
+            {
+            if ((key == nullptr) || (lx <= 0) || (ly <= 0)) return false;
+            if (_find(key) >= 0) return true; // already registered
+            int i = 0;
+            while ((i < _nb) && (_entries[i].key != nullptr)) i++; // reuse a free slot if any
+            if (i >= MAXTEXTURES) return false;
+            if (i == _nb) _nb++;
+            _Entry& E = _entries[i];
+            E.key = key;
+            E.lx = lx;
+            E.ly = ly;
+            E.load = load;
+            E.ctx = ctx;
+            E.buf = nullptr;
+            E.last_use = 0;
+            return true;
+            }
+
+
+        /**
+        * Unregister a texture (and release its memory if it is in the cache). The other
+        * entries are not moved so the images returned by get() for the other keys remain
+        * valid.
+        **/
+        void removeTexture(const Image<color_t>* key)
+            {
+            const int i = _find(key);
+            if (i < 0) return;
+            _evict(i);
+            _entries[i].key = nullptr; // free slot
+            while ((_nb > 0) && (_entries[_nb - 1].key == nullptr)) _nb--;
+            }
+
+
+        /**
+        * Return the image to use for a given key. If the texture is registered, it is loaded
+        * in the cache when needed and marked as the most recently used one. If it cannot be
+        * loaded, the key itself is returned when it has a valid buffer and nullptr otherwise.
+        * Keys that are not registered are returned unchanged.
+        *
+        * The image returned for a registered key always lives at the same address (until the
+        * key is removed) but it is emptied when the texture is evicted: get() should be called
+        * again before each use instead of keeping the pointer.
+        **/
+        const Image<color_t>* get(const Image<color_t>* key)
+            {
+            const int i = _find(key);
+            if (i < 0) return key;
+            _Entry& E = _entries[i];
+            E.last_use = ++_clock;
+            if (E.buf)
+                {
+                _stats.hits++;
+                return &E.im;
+                }
+            _stats.misses++;
+            if (_load(E)) return &E.im;
+            _stats.failures++;
+            return ((key->isValid()) ? key : nullptr);
+            }
+
+
+        /**
+        * Evict all the textures from the cache (they stay registered).
+        **/
+        void clear()
+            {
+            for (int i = 0; i < _nb; i++) _evict(i);
+            }
+
+
+        /**
+        * Change the budget (textures are evicted if needed).
+        **/
+        void setBudget(size_t budget)
+            {
+            _budget = budget;
+            _makeRoom(0);
+            }
+
+
+        /**
+        * Return the budget in bytes.
+        **/
+        size_t budget() const { return _budget; }
+
+
+        /**
+        * Return the number of bytes currently used by the textures in the cache.
+        **/
+        size_t usedBytes() const { return _used; }
+
+
+        /**
+        * Return the counters accumulated since the last call to resetStats().
+        **/
+        Stats getStats() const { return _stats; }
+
+
+        /**
+        * Reset the counters.
+        **/
+        void resetStats()
+            {
+            _stats.hits = 0;
+            _stats.misses = 0;
+            _stats.evictions = 0;
+            _stats.failures = 0;
+            _stats.bytes_loaded = 0;
+            }
+
+
+    private:
+
+
+        /** a texture managed by the cache */
+        struct _Entry
+            {
+            const Image<color_t>* key;  // texture key
+            int lx, ly;                 // texture size
+            LoadFunction load;          // loading function (nullptr to copy from the key)
+            void* ctx;                  // context given to the loading function
+            color_t* buf;               // pixels in the cache (nullptr if not loaded)
+            Image<color_t> im;          // image encapsulating buf
+            uint32_t last_use;          // time of the last request
+            };
+
+
+        /** index of the entry with a given key or -1 (free slots have a nullptr key) */
+        int _find(const Image<color_t>* key) const
+            {
+            if (key == nullptr) return -1;
+            for (int i = 0; i < _nb; i++)
+                {
+                if (_entries[i].key == key) return i;
+                }
+            return -1;
+            }
+
+
+        /** size in bytes of a texture */
+        static size_t _size(const _Entry& E)
+            {
+            return ((size_t)E.lx) * E.ly * sizeof(color_t);
+            }
+
+
+        /** release the memory of a texture */
+        void _evict(int i)
+            {
+            _Entry& E = _entries[i];
+            if (E.buf == nullptr) return;
+            memFree(E.buf);
+            E.buf = nullptr;
+            E.im.set((color_t*)nullptr, 0, 0);
+            _used -= _size(E);
+            }
+
+
+        /** evict least recently used textures until 'size' more bytes fit in the budget */
+        bool _makeRoom(size_t size)
+            {
+            while (_used + size > _budget)
+                {
+                int lru = -1;
+                for (int i = 0; i < _nb; i++)
+                    {
+                    if ((_entries[i].buf) && ((lru < 0) || (_entries[i].last_use < _entries[lru].last_use))) lru = i;
+                    }
+                if (lru < 0) return false;
+                _evict(lru);
+                _stats.evictions++;
+                }
+            return true;
+            }
+
+
+        /** load a texture in the cache */
+        bool _load(_Entry& E)
+            {
+            const size_t size = _size(E);
+            if (size > _budget) return false;
+            if (E.load == nullptr)
+                { // copying from the key: must have a valid buffer of the right size
+                if ((!E.key->isValid()) || (E.key->lx() != E.lx) || (E.key->ly() != E.ly)) return false;
+                }
+            if (!_makeRoom(size)) return false;
+            E.buf = (color_t*)memAlloc(size, (_extmem) ? TGX_MEM_EXTMEM : TGX_MEM_INTERNAL);
+            if (E.buf == nullptr) return false;
+            bool ok = true;
+            if (E.load)
+                {
+                ok = E.load(E.ctx, E.buf, E.lx, E.ly);
+                }
+            else
+                {
+                for (int y = 0; y < E.ly; y++) memcpy(E.buf + y * E.lx, E.key->data() + y * E.key->stride(), E.lx * sizeof(color_t));
+                }
+            if (!ok)
+                {
+                memFree(E.buf);
+                E.buf = nullptr;
+                return false;
+                }
+            E.im.set(E.buf, E.lx, E.ly);
+            _used += size;
+            _stats.bytes_loaded += (uint32_t)size;
+            return true;
+            }
+
+
+        size_t  _budget;                    // maximum number of bytes for the textures
+        size_t  _used;                      // number of bytes currently used
+        bool    _extmem;                    // true to allocate in external RAM
+        int     _nb;                        // number of slots used in _entries (free slots have a nullptr key)
+        uint32_t _clock;                    // incremented at each request
+        _Entry  _entries[MAXTEXTURES];      // registered textures
+        Stats   _stats;                     // usage counters
+
+    };
+
+
+}
+
+
+#endif
+
+#endif
+
+/** end of file **/
+
@@ -32,9 +32,19 @@
 #include "Box2.h"
 #include "Box3.h"
 #include "Color.h"
+#include "Simd.h"
 #include "Image.h"
+#include "ImageRLE.h"
+#include "GlyphCache.h"
+#include "DisplayList.h"
 #include "Mesh3D.h"
+#include "MeshFile.h"
+#include "TextureCache.h"
 #include "Renderer3D.h"
+#include "Scene3D.h"
+#include "DynamicResolution.h"
+#include "ImageUpscaler.h"
+#include "FramePipeline.h"
 
 #endif
 
@@ -0,0 +1,175 @@
+/********************************************************************
+* tgx host benchmark : blending on RGB565 images.
+*
+* Compares blit() / blitMasked() / fillRect() with opacity on RGB565
+* images with plain scalar loops that blend one pixel at a time with
+* RGB565::blend256() (copied below).
+*
+* 1. Draws 3000 random (clipped, overlapping) operations with both
+*    versions and prints the number of differing pixels (must be 0).
+*
+* 2. Prints the time of full screen operations for both versions
+*    (best of several runs, alternated between the two versions).
+*
+* Build it without the host vector kernels and without vectorization
+* of the scalar loops to get closer to the code generated for an MCU:
+*
+*   g++ -O2 -fno-tree-vectorize -std=c++17 -fpermissive -w -DTGX_SIMD=0 -I../../src blend565.cpp ../../src/Color.cpp -o blend565
+*
+* or with the default flags to measure the host vector kernels.
+********************************************************************/
+
+#include <tgx.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+
+using namespace tgx;
+
+#define LX 320
+#define LY 240
+
+#define SX 100  // size of the sprite
+#define SY 80
+
+#define NB_OPS 50       // operations per run
+#define NB_RUNS 31      // the best run is reported
+
+RGB565 fb[LX * LY];
+RGB565 ref[LX * LY];
+RGB565 sprite[SX * SY];
+
+
+/** scalar blit with opacity (generic loop of _blendRegionUp) */
+void scalarBlit(Image<RGB565>& dst, const Image<RGB565>& src, iVec2 pos, float opacity)
+    {
+    const iBox2 B = dst.imageBox() & iBox2(pos.x, pos.x + src.lx() - 1, pos.y, pos.y + src.ly() - 1);
+    if (B.isEmpty()) return;
+    const int op256 = (int)(opacity * 256);
+    for (int j = B.minY; j <= B.maxY; j++)
+        {
+        RGB565* pdest2 = dst.data() + B.minX + j * dst.stride();
+        const RGB565* psrc2 = src.data() + (B.minX - pos.x) + (j - pos.y) * src.stride();
+        for (int i = 0; i < B.lx(); i++)
+            {
+            pdest2[i].blend256(psrc2[i], op256);
+            }
+        }
+    }
+
+
+/** scalar masked blit with opacity (generic loop of _maskRegionUp) */
+void scalarBlitMasked(Image<RGB565>& dst, const Image<RGB565>& src, RGB565 transparent_color, iVec2 pos, float opacity)
+    {
+    const iBox2 B = dst.imageBox() & iBox2(pos.x, pos.x + src.lx() - 1, pos.y, pos.y + src.ly() - 1);
+    if (B.isEmpty()) return;
+    const int op256 = (int)(opacity * 256);
+    for (int j = B.minY; j <= B.maxY; j++)
+        {
+        RGB565* pdest2 = dst.data() + B.minX + j * dst.stride();
+        const RGB565* psrc2 = src.data() + (B.minX - pos.x) + (j - pos.y) * src.stride();
+        for (int i = 0; i < B.lx(); i++)
+            {
+            RGB565 c = psrc2[i];
+            if (c != transparent_color) pdest2[i].blend256(c, op256);
+            }
+        }
+    }
+
+
+/** scalar fillRect with opacity (generic loop of fillRect) */
+void scalarFillRect(Image<RGB565>& dst, iBox2 B, RGB565 color, float opacity)
+    {
+    B &= dst.imageBox();
+    if (B.isEmpty()) return;
+    for (int j = B.minY; j <= B.maxY; j++)
+        {
+        RGB565* p = dst.data() + B.minX + j * dst.stride();
+        int len = B.lx();
+        while (len-- > 0) { (*(p++)).blend(color, opacity); }
+        }
+    }
+
+
+/** draw random operations with both versions, return the number of differing pixels */
+long compare()
+    {
+    Image<RGB565> im(fb, LX, LY), imr(ref, LX, LY), spr(sprite, SX, SY);
+    for (int i = 0; i < LX * LY; i++) fb[i] = ref[i] = RGB565((uint16_t)(i * 31));
+    srand(5);
+    long bad = 0;
+    for (int it = 0; it < 3000; it++)
+        {
+        const iVec2 pos(rand() % (LX + SX) - SX + 10, rand() % (LY + SY) - SY + 10);
+        const float op = (rand() % 101) / 100.0f;
+        const RGB565 tr = sprite[rand() % (SX * SY)];
+        switch (it % 3)
+            {
+            case 0: im.blit(spr, pos, op); scalarBlit(imr, spr, pos, op); break;
+            case 1: im.blitMasked(spr, tr, pos, op); scalarBlitMasked(imr, spr, tr, pos, op); break;
+            case 2:
+                {
+                const iBox2 B(pos.x, pos.x + rand() % 150, pos.y, pos.y + rand() % 100);
+                const RGB565 c((uint16_t)rand());
+                im.fillRect(B, c, op); scalarFillRect(imr, B, c, op);
+                break;
+                }
+            }
+        if (it % 100 == 99)
+            {
+            for (int i = 0; i < LX * LY; i++) { if ((uint16_t)fb[i] != (uint16_t)ref[i]) bad++; }
+            memcpy(ref, fb, sizeof(fb));
+            }
+        }
+    return bad;
+    }
+
+
+/** time (in microseconds) of one call of op */
+template<typename FUN> double timeit(FUN op)
+    {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < NB_OPS; i++) op(i);
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / NB_OPS;
+    }
+
+
+/** best times of opA and opB over NB_RUNS runs (alternated so that both see the same load of the host) */
+template<typename FUNA, typename FUNB> void compareTimes(const char* name, FUNA opA, FUNB opB)
+    {
+    double ta = 1e9, tb = 1e9;
+    for (int r = 0; r < NB_RUNS; r++)
+        {
+        ta = fmin(ta, timeit(opA));
+        tb = fmin(tb, timeit(opB));
+        }
+    printf("%-28s %8.1f us %8.1f us\n", name, ta, tb);
+    }
+
+
+int main()
+    {
+    srand(1);
+    for (int i = 0; i < SX * SY; i++) sprite[i] = (i % 7 == 0) ? RGB565_Black : RGB565((uint16_t)rand());
+    printf("TGX_SIMD = %d\n", TGX_SIMD);
+    printf("differing pixels with the scalar loops: %ld\n", compare());
+
+    Image<RGB565> im(fb, LX, LY), spr(sprite, SX, SY);
+    const iBox2 full(0, LX - 1, 0, LY - 1);
+    printf("%-28s %10s %10s\n", "full screen", "scalar", "library");
+    compareTimes("blit with opacity (9x)",
+        [&](int i) { for (int k = 0; k < 9; k++) scalarBlit(im, spr, iVec2((k % 3) * 100 + (i & 1), (k / 3) * 80), 0.5f); },
+        [&](int i) { for (int k = 0; k < 9; k++) im.blit(spr, iVec2((k % 3) * 100 + (i & 1), (k / 3) * 80), 0.5f); });
+    compareTimes("masked blit (9x)",
+        [&](int i) { for (int k = 0; k < 9; k++) scalarBlitMasked(im, spr, RGB565_Black, iVec2((k % 3) * 100 + (i & 1), (k / 3) * 80), 0.5f); },
+        [&](int i) { for (int k = 0; k < 9; k++) im.blitMasked(spr, RGB565_Black, iVec2((k % 3) * 100 + (i & 1), (k / 3) * 80), 0.5f); });
+    compareTimes("fillRect with opacity",
+        [&](int i) { scalarFillRect(im, full, RGB565((uint16_t)i), 0.5f); },
+        [&](int i) { im.fillRect(full, RGB565((uint16_t)i), 0.5f); });
+    return 0;
+    }
+
+
+/** end of file */
@@ -0,0 +1,102 @@
+/********************************************************************
+* tgx host benchmark : SIMD fill/blend rows of the 2D methods.
+*
+* Draws a few thousand random (clipped) fills, blits and masked blits
+* with opacity in RGB565 and RGB32 images and prints a hash of the
+* result, then times full screen operations (best of several runs).
+*
+* Build it once per instruction set and compare: the hashes must be
+* identical, only the timings change.
+*
+*   g++ -O2 -std=c++17 -fpermissive -w -I../../src simd_2d.cpp ../../src/Color.cpp -o simd_2d                 (SSE2)
+*   g++ -O2 -std=c++17 -fpermissive -w -mavx2 -I../../src simd_2d.cpp ../../src/Color.cpp -o simd_2d_avx2     (AVX2)
+*   g++ -O2 -std=c++17 -fpermissive -w -DTGX_SIMD=0 -I../../src simd_2d.cpp ../../src/Color.cpp -o simd_2d_0  (scalar)
+********************************************************************/
+
+#include <tgx.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+using namespace tgx;
+
+#define LX 320
+#define LY 240
+
+#define NB_OPS 2000     // operations per run
+#define NB_RUNS 7       // the best run is reported
+
+RGB565 fb[LX * LY];
+RGB32 fb32[LX * LY];
+RGB565 sprite[100 * 80];
+
+
+/** FNV-1a hash of a buffer */
+uint64_t hash64(const void* p, size_t n, uint64_t h = 1469598103934665603ULL)
+    {
+    const uint8_t* b = (const uint8_t*)p;
+    for (size_t i = 0; i < n; i++) { h ^= b[i]; h *= 1099511628211ULL; }
+    return h;
+    }
+
+
+/** best time (in microseconds) of op() over NB_RUNS runs of NB_OPS calls */
+template<typename FUN> void timeit(const char* name, FUN op)
+    {
+    double best = 1e9;
+    for (int r = 0; r < NB_RUNS; r++)
+        {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < NB_OPS; i++) op(i);
+        const double t = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / NB_OPS;
+        if (t < best) best = t;
+        }
+    printf("%-28s %8.2f us\n", name, best);
+    }
+
+
+int main()
+    {
+    printf("TGX_SIMD = %d\n", TGX_SIMD);
+
+    Image<RGB565> im(fb, LX, LY);
+    Image<RGB32> im32(fb32, LX, LY);
+    Image<RGB565> spr(sprite, 100, 80);
+    srand(7);
+    for (int i = 0; i < 100 * 80; i++) sprite[i] = RGB565((uint16_t)(rand() & ((i % 3) ? 0xFFFF : 0x001F)));
+    for (int i = 0; i < LX * LY; i++) fb[i] = RGB565((uint16_t)rand());
+
+    // random operations (clipped, any opacity, overlapping source and destination)
+    uint64_t h = 1469598103934665603ULL;
+    for (int it = 0; it < 4000; it++)
+        {
+        const int x = rand() % 400 - 60, y = rand() % 300 - 40, w = rand() % 120 + 1, hh = rand() % 60 + 1;
+        const float op = (rand() % 101) / 100.0f;
+        const RGB565 c((uint16_t)rand());
+        switch (it % 6)
+            {
+            case 0: im.fillRect(iVec2(x, y), iVec2(w, hh), c); break;
+            case 1: im.fillRect(iVec2(x, y), iVec2(w, hh), c, op); break;
+            case 2: im.blit(spr, iVec2(x, y), op); break;
+            case 3: im.blitMasked(spr, RGB565((uint16_t)(0x001F & sprite[rand() % 8000].val)), iVec2(x, y), op); break;
+            case 4: { Image<RGB565> sub = im.getCrop(iBox2(10, 200, 10, 150)); im.blit(sub, iVec2(x % 50, y % 50), op); break; }
+            case 5: { Image<RGB565> sub = im.getCrop(iBox2(10, 200, 10, 150)); im.blit(sub, iVec2(x % 30 - 15, y % 30 - 15)); break; }
+            }
+        im32.fillRect(iVec2(x, y), iVec2(w, hh), RGB32((uint32_t)rand()));
+        if (it % 500 == 0) h = hash64(fb, sizeof(fb), h);
+        }
+    h = hash64(fb, sizeof(fb), h);
+    printf("hash RGB565 %016llx  RGB32 %016llx\n", (unsigned long long)h, (unsigned long long)hash64(fb32, sizeof(fb32)));
+
+    // full screen timings
+    timeit("fillScreen", [&](int i) { im.fillScreen(RGB565((uint16_t)i)); });
+    timeit("fillScreen (RGB32)", [&](int i) { im32.fillScreen(RGB32((uint32_t)i)); });
+    timeit("fillRect with opacity", [&](int i) { im.fillRect(iVec2(0, 0), iVec2(LX, LY), RGB565((uint16_t)i), 0.5f); });
+    timeit("blit with opacity (9x)", [&](int i) { for (int k = 0; k < 9; k++) im.blit(spr, iVec2((k % 3) * 100, (k / 3) * 80), 0.5f); });
+    timeit("masked blit (9x)", [&](int i) { for (int k = 0; k < 9; k++) im.blitMasked(spr, RGB565((uint16_t)0), iVec2((k % 3) * 100, (k / 3) * 80), 0.5f); });
+    return 0;
+    }
+
+
+/** end of file */
+
@@ -0,0 +1,127 @@
+/********************************************************************
+* tgx host benchmark : SIMD span kernels of the 3D shaders.
+*
+* Draws large flat and Gouraud triangles (with and without z-buffer)
+* in a 320x240 RGB565 image and prints, for each case, a hash of the
+* rendered frames and the best time per frame over several runs.
+*
+* Build it once per instruction set and compare: the hashes must be
+* identical, only the timings change.
+*
+*   g++ -O2 -std=c++17 -fpermissive -w -I../../src simd_3d.cpp ../../src/Color.cpp -o simd_3d                 (SSE2)
+*   g++ -O2 -std=c++17 -fpermissive -w -mavx2 -I../../src simd_3d.cpp ../../src/Color.cpp -o simd_3d_avx2     (AVX2)
+*   g++ -O2 -std=c++17 -fpermissive -w -DTGX_SIMD=0 -I../../src simd_3d.cpp ../../src/Color.cpp -o simd_3d_0  (scalar)
+********************************************************************/
+
+#include <tgx.h>
+#include <stdio.h>
+#include <chrono>
+
+using namespace tgx;
+
+#define LX 320
+#define LY 240
+
+#define NB_FRAMES 300   // frames per run
+#define NB_RUNS 7       // the best run is reported
+
+RGB565 fb[LX * LY];
+float zbuf[LX * LY];
+
+
+/** FNV-1a hash of a buffer */
+uint64_t hash64(const void* p, size_t n, uint64_t h = 1469598103934665603ULL)
+    {
+    const uint8_t* b = (const uint8_t*)p;
+    for (size_t i = 0; i < n; i++) { h ^= b[i]; h *= 1099511628211ULL; }
+    return h;
+    }
+
+
+/** set the model matrix for frame f and clear the image (and the z-buffer) */
+template<bool ZBUFFER> void startFrame(Renderer3D<RGB565, LX, LY, ZBUFFER, false>& renderer, Image<RGB565>& im, int f)
+    {
+    fMat4 M;
+    M.setIdentity();
+    M.multRotate(f * 3.0f, { 0, 0, 1 });
+    M.multRotate(20.0f * ((f % 7) - 3), { 1, 0, 0 });
+    M.multTranslate({ 0, 0, -2.2f });
+    renderer.setModelMatrix(M);
+    im.fillScreen(RGB565_Black);
+    if constexpr (ZBUFFER) renderer.clearZbuffer();
+    }
+
+
+/** draw 8 large triangles covering most of the screen */
+template<bool ZBUFFER> void drawTriangles(Renderer3D<RGB565, LX, LY, ZBUFFER, false>& renderer, bool gouraud)
+    {
+    for (int k = 0; k < 4; k++)
+        {
+        const float d = 0.1f * k;
+        const fVec3 A(-1.2f + d, -1, -d), B(1.2f, -1 + d, d * 0.5f), C(0, 1.1f - d, -0.3f * d), D(-1.1f, 1.0f, 0.2f);
+        const fVec3 N(0, 0, 1);
+        if (gouraud)
+            {
+            renderer.drawTriangleWithVertexColor(TGX_SHADER_GOURAUD, A, B, C, N, N, N, RGBf(1, 0, 0), RGBf(0, 1, 0), RGBf(0, 0.3f * k, 1));
+            renderer.drawTriangleWithVertexColor(TGX_SHADER_GOURAUD, A, C, D, N, N, N, RGBf(1, 0, 0), RGBf(0, 0.3f * k, 1), RGBf(1, 1, 0));
+            }
+        else
+            {
+            renderer.setMaterialColor(RGBf(0.2f * k, 0.5f, 0.7f));
+            renderer.drawTriangle(TGX_SHADER_FLAT, A, B, C);
+            renderer.drawTriangle(TGX_SHADER_FLAT, A, C, D);
+            }
+        }
+    }
+
+
+template<bool ZBUFFER> void run(const char* name, bool gouraud)
+    {
+    Image<RGB565> im(fb, LX, LY);
+    Renderer3D<RGB565, LX, LY, ZBUFFER, false> renderer;
+    renderer.setImage(&im);
+    if constexpr (ZBUFFER) renderer.setZbuffer(zbuf, LX * LY);
+    renderer.setPerspective(45, ((float)LX) / LY, 1.0f, 100.0f);
+    renderer.setCulling(0);
+
+    // hash of all the frames (and of the z-buffer)
+    uint64_t h = 1469598103934665603ULL;
+    for (int f = 0; f < NB_FRAMES; f++)
+        {
+        startFrame<ZBUFFER>(renderer, im, f);
+        drawTriangles<ZBUFFER>(renderer, gouraud);
+        h = hash64(fb, sizeof(fb), h);
+        if (ZBUFFER) h = hash64(zbuf, sizeof(zbuf), h);
+        }
+
+    // best time per frame (drawing only, the image is cleared outside of the timed part)
+    double best = 1e9;
+    for (int r = 0; r < NB_RUNS; r++)
+        {
+        double t = 0;
+        for (int f = 0; f < NB_FRAMES; f++)
+            {
+            startFrame<ZBUFFER>(renderer, im, f);
+            auto t0 = std::chrono::steady_clock::now();
+            drawTriangles<ZBUFFER>(renderer, gouraud);
+            t += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            }
+        if (t / NB_FRAMES < best) best = t / NB_FRAMES;
+        }
+    printf("%-28s %016llx %8.3f ms/frame\n", name, (unsigned long long)h, best);
+    }
+
+
+int main()
+    {
+    printf("TGX_SIMD = %d\n", TGX_SIMD);
+    run<false>("large flat triangles", false);
+    run<true>("large flat + zbuffer", false);
+    run<false>("large gouraud triangles", true);
+    run<true>("large gouraud + zbuffer", true);
+    return 0;
+    }
+
+
+/** end of file */
+
@@ -0,0 +1,163 @@
+/********************************************************************
+* tgx host test : triangle setup of the rasterizer.
+*
+* Rasterizes about 950k random triangles (from subpixel size to far
+* beyond the clipping bounds, several viewport sizes and tile offsets)
+* with both rasterizeTriangle() versions and a shader that records its
+* arguments. Prints a hash of the arguments received by the shader, a
+* hash of the covered pixels (evaluated from these arguments) and the
+* setup time of small and medium triangles.
+*
+* Building it against two versions of the library (e.g. a second
+* checkout made with 'git worktree add') and comparing the hashes checks
+* that a change of the setup code does not change the rasterization.
+* The coverage pass visits ~10^10 pixels and takes about a minute.
+*
+*   g++ -O2 -std=c++17 -fpermissive -w -I../../src triangle_setup.cpp ../../src/Color.cpp -o triangle_setup
+********************************************************************/
+
+#include <tgx.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+
+using namespace tgx;
+
+uint64_t hash_args = 1469598103934665603ULL;   // hash of the shader arguments
+uint64_t hash_cover = 1469598103934665603ULL;  // hash of the covered pixels
+uint64_t nb_calls = 0;                         // number of shader calls
+uint64_t nb_cover = 0;                         // number of covered pixels
+volatile int32_t sink = 0;
+
+
+inline void mix(uint64_t& h, int64_t v)
+    {
+    h ^= (uint64_t)v;
+    h *= 1099511628211ULL;
+    }
+
+
+/** shader that records its arguments and the pixels it would draw */
+template<typename color_t> void recordShader(const int32_t& offset, const int32_t& lx, const int32_t& ly,
+    const int32_t& dx1, const int32_t& dy1, int32_t O1, const RasterizerVec4& fP1,
+    const int32_t& dx2, const int32_t& dy2, int32_t O2, const RasterizerVec4& fP2,
+    const int32_t& dx3, const int32_t& dy3, int32_t O3, const RasterizerVec4& fP3,
+    const RasterizerParams<color_t, color_t>& data)
+    {
+    nb_calls++;
+    const int64_t args[] = { offset, lx, ly, dx1, dy1, O1, dx2, dy2, O2, dx3, dy3, O3,
+                             (int64_t)(fP1.x * 1e6), (int64_t)(fP2.x * 1e6), (int64_t)(fP3.x * 1e6) };
+    for (int64_t v : args) mix(hash_args, v);
+    const int32_t stride = data.im->stride();
+    for (int y = 0; y < ly; y++)
+        {
+        for (int x = 0; x < lx; x++)
+            {
+            const int32_t a = O1 + x * dx1 + y * dy1;
+            const int32_t b = O2 + x * dx2 + y * dy2;
+            const int32_t c = O3 + x * dx3 + y * dy3;
+            if ((a | b | c) >= 0) { nb_cover++; mix(hash_cover, offset + x + y * stride); }
+            }
+        }
+    }
+
+
+/** shader that does nothing (for timing the setup) */
+template<typename color_t> void emptyShader(const int32_t& offset, const int32_t& lx, const int32_t& ly,
+    const int32_t& dx1, const int32_t& dy1, int32_t O1, const RasterizerVec4& fP1,
+    const int32_t& dx2, const int32_t& dy2, int32_t O2, const RasterizerVec4& fP2,
+    const int32_t& dx3, const int32_t& dy3, int32_t O3, const RasterizerVec4& fP3,
+    const RasterizerParams<color_t, color_t>& data)
+    {
+    sink += (O1 ^ O2 ^ O3) & 1;
+    }
+
+
+/** random float in [-1,1] with a resolution of 1/n */
+float rnd(int n)
+    {
+    return ((rand() % (2 * n + 1)) / (float)n) - 1.0f;
+    }
+
+
+/** N random triangles in a W x H image at offset (ox, oy) of a LX x LY viewport */
+template<int LX, int LY> void run(int ox, int oy, int W, int H, float range, int N)
+    {
+    static RGB565 fb[2048 * 2048];
+    Image<RGB565> im(fb, W, H);
+    RasterizerParams<RGB565, RGB565> data;
+    data.im = &im;
+    srand(12345);
+    for (int n = 0; n < N; n++)
+        {
+        RasterizerVec4 V[3];
+        const float sc = range * powf(2.0f, -(float)(rand() % 14)); // sizes from huge to subpixel
+        const float cx = rnd(1000), cy = rnd(1000);
+        for (int k = 0; k < 3; k++)
+            {
+            V[k].x = cx + sc * rnd(10000);
+            V[k].y = cy + sc * rnd(10000);
+            V[k].z = 0;
+            V[k].w = 1;
+            }
+        rasterizeTriangle<LX, LY>(V[0], V[1], V[2], ox, oy, data, recordShader<RGB565>);
+        rasterizeTriangle(LX, LY, V[0], V[1], V[2], ox, oy, data, recordShader<RGB565>);
+        }
+    }
+
+
+/** setup time (in ns per triangle) of triangles of size sc (in normalized coordinates) */
+double bench(float sc)
+    {
+    static RGB565 fb[320 * 240];
+    Image<RGB565> im(fb, 320, 240);
+    RasterizerParams<RGB565, RGB565> data;
+    data.im = &im;
+    const int N = 4096;
+    static RasterizerVec4 V[N * 3];
+    srand(7);
+    for (int i = 0; i < N * 3; i++)
+        {
+        V[i].x = rnd(1000) * 0.9f;
+        V[i].y = rnd(1000) * 0.9f;
+        if (i % 3)
+            {
+            V[i].x = V[i - i % 3].x + sc * rnd(1000);
+            V[i].y = V[i - i % 3].y + sc * rnd(1000);
+            }
+        V[i].z = 0;
+        V[i].w = 1;
+        }
+    double best = 1e9;
+    for (int r = 0; r < 15; r++)
+        {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int k = 0; k < 50; k++)
+            {
+            for (int i = 0; i < N; i++) rasterizeTriangle<320, 240>(V[3 * i], V[3 * i + 1], V[3 * i + 2], 0, 0, data, emptyShader<RGB565>);
+            }
+        const double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        if (t < best) best = t;
+        }
+    return best * 1e9 / (50.0 * N);
+    }
+
+
+int main()
+    {
+    run<320, 240>(0, 0, 320, 240, 7.0f, 200000);
+    run<320, 240>(100, 40, 120, 90, 7.0f, 200000);     // tile
+    run<1024, 1024>(0, 0, 1024, 1024, 2.0f, 100000);
+    run<2048, 2048>(0, 0, 2048, 2048, 1.0f, 100000);
+    run<160, 128>(0, 0, 160, 128, 12.0f, 100000);
+    run<320, 240>(0, 0, 320, 240, 1.0e8f, 50000);    // vertices so far away that their snapped position saturates
+    printf("shader calls %llu  arguments %016llx\n", (unsigned long long)nb_calls, (unsigned long long)hash_args);
+    printf("covered pixels %llu  coverage %016llx\n", (unsigned long long)nb_cover, (unsigned long long)hash_cover);
+    printf("setup time: small triangles %.1f ns, medium triangles %.1f ns\n", bench(0.02f), bench(0.2f));
+    return 0;
+    }
+
+
+/** end of file */
+
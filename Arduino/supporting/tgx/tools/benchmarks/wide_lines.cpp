@@ -0,0 +1,64 @@
+/********************************************************************
+* tgx host benchmark : anti-aliased wide lines, wedges and spots.
+*
+* Draws 100000 random primitives of each kind (short segments spread
+* over a 320x240 RGB565 image) and prints the number of primitives per
+* second (best of several runs).
+*
+* To compare two versions of the library, build it against each of them
+* (e.g. a second checkout made with 'git worktree add') and run both.
+*
+*   g++ -O2 -std=c++17 -fpermissive -w -I../../src wide_lines.cpp ../../src/Color.cpp -o wide_lines
+********************************************************************/
+
+#include <tgx.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+using namespace tgx;
+
+#define LX 320
+#define LY 240
+
+#define NB_PRIMITIVES 100000    // primitives per run
+#define NB_RUNS 7               // the best run is reported
+
+RGB565 fb[LX * LY];
+
+
+int main()
+    {
+    Image<RGB565> im(fb, LX, LY);
+    const char* names[] = { "wide line w=3", "wide line w=12", "wedge 16->4", "spot r=4", "spot r=20" };
+    for (int t = 0; t < 5; t++)
+        {
+        double best = 0;
+        for (int r = 0; r < NB_RUNS; r++)
+            {
+            srand(1);
+            auto t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < NB_PRIMITIVES; i++)
+                {
+                const fVec2 A((float)(rand() % LX), (float)(rand() % LY));
+                const fVec2 B = A + fVec2((float)((rand() % 80) - 40), (float)((rand() % 80) - 40));
+                switch (t)
+                    {
+                    case 0: im.drawWideLine(A, B, 3, RGB565_Red, 1.0f); break;
+                    case 1: im.drawWideLine(A, B, 12, RGB565_Red, 0.5f); break;
+                    case 2: im.drawWedgeLine(A, B, 16, 4, RGB565_Red, 1.0f); break;
+                    case 3: im.drawSpot(A, 4, RGB565_Red, 1.0f); break;
+                    case 4: im.drawSpot(A, 20, RGB565_Red, 1.0f); break;
+                    }
+                }
+            const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            if (NB_PRIMITIVES / s > best) best = NB_PRIMITIVES / s;
+            }
+        printf("%-16s %10.0f primitives/s\n", names[t], best);
+        }
+    return 0;
+    }
+
+
+/** end of file */
+
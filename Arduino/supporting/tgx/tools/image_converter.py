@@ -196,6 +196,128 @@ def createCPP(ar, color_type, name, tc):
     
 
 
+# In[ ]:
+
+
+# RLE format (see ImageRLE.h): run types and maximum length of a run
+RLE_TRANSPARENT = 0
+RLE_OPAQUE = 1
+RLE_SOLID = 2
+RLE_ALPHA = 3
+RLE_MAXRUN = 16383
+
+# minimum number of identical pixels stored as a solid run inside an opaque area
+RLE_MINSOLID = 4
+
+# RGB565 value of a pixel (array already converted to 5/6/5 bits)
+def value565(p):
+    return (int(p[0]) << 11) | (int(p[1]) << 5) | int(p[2])
+
+# run type of a pixel: transparent when alpha < alpha_threshold, translucent when
+# keep_alpha is set and alpha < 255, opaque otherwise.
+def pixelRunType(p, alpha_threshold, keep_alpha):
+    if p[3] < alpha_threshold:
+        return RLE_TRANSPARENT
+    if keep_alpha and (p[3] < 255):
+        return RLE_ALPHA
+    return RLE_OPAQUE
+
+# encode a sequence of opaque colors as opaque and solid runs
+def encodeOpaque(cols):
+    words = []
+    lit = []
+    def flush():
+        if len(lit) > 0:
+            words.extend([(RLE_OPAQUE << 14) | len(lit)] + lit)
+            lit.clear()
+    i = 0
+    while i < len(cols):
+        e = i
+        while (e < len(cols)) and (cols[e] == cols[i]):
+            e += 1
+        if e - i >= RLE_MINSOLID:
+            flush()
+            words.extend([(RLE_SOLID << 14) | (e - i), cols[i]])
+        else:
+            lit.extend(cols[i:e])
+        i = e
+    flush()
+    return words
+
+# encode line y of the image
+def encodeRLELine(ar, y, alpha_threshold, keep_alpha):
+    width = ar.shape[0]
+    words = []
+    x = 0
+    while x < width:
+        t = pixelRunType(ar[x, y], alpha_threshold, keep_alpha)
+        e = x + 1
+        while (e < width) and (e - x < RLE_MAXRUN) and (pixelRunType(ar[e, y], alpha_threshold, keep_alpha) == t):
+            e += 1
+        if t == RLE_TRANSPARENT:
+            words.append((RLE_TRANSPARENT << 14) | (e - x))
+        elif t == RLE_OPAQUE:
+            words.extend(encodeOpaque([value565(ar[i, y]) for i in range(x, e)]))
+        else:
+            alphas = [int(ar[i, y, 3]) for i in range(x, e)] + [0]
+            words.append((RLE_ALPHA << 14) | (e - x))
+            words.extend([value565(ar[i, y]) for i in range(x, e)])
+            words.extend([alphas[k] | (alphas[k + 1] << 8) for k in range(0, e - x, 2)])
+        x = e
+    return words
+
+
+def createRLE(ar, name, alpha_threshold, keep_alpha):
+    
+    width = ar.shape[0]
+    height = ar.shape[1]
+    data = []
+    lines = []
+    for y in range(height):
+        lines.append(len(data))
+        data.extend(encodeRLELine(ar, y, alpha_threshold, keep_alpha))
+    size = len(data)*2 + len(lines)*4
+    
+    with open(name + ".cpp", "w") as f:           
+        f.write('//\n');
+        f.write(f'// RLE image: {name}\n');
+        f.write(f'// dimension: {width}x{height}\n');
+        f.write(f'// Size: {int(round(size / 1024))}kb (instead of {int(round(width*height*2 / 1024))}kb)\n');        
+        f.write(f'//\n\n');
+        f.write(f'#include "{name}.h"\n\n');
+        f.write(f'// runs\n');
+        f.write(f'static const uint16_t {name}_data[{len(data)}] PROGMEM = {{\n');
+        for i in range(0, len(data), 16):
+            f.write(", ".join([f"{w}" for w in data[i:i+16]]))
+            f.write(",\n" if i + 16 < len(data) else "\n")
+        f.write('};\n\n')
+        f.write(f'// offset of each line\n');
+        f.write(f'static const uint32_t {name}_lines[{height}] PROGMEM = {{\n');
+        for i in range(0, height, 16):
+            f.write(", ".join([f"{o}" for o in lines[i:i+16]]))
+            f.write(",\n" if i + 16 < height else "\n")
+        f.write('};\n\n')
+        f.write(f'// image object\n');        
+        f.write(f'const tgx::ImageRLE {name}({name}_data, {name}_lines, {width}, {height});\n\n');             
+        f.write(f'// end of file {name}.cpp\n\n')
+    
+    with open(name + ".h", "w") as f:           
+        f.write('//\n');
+        f.write(f'// RLE image: {name}\n');
+        f.write(f'// dimension: {width}x{height}\n');
+        f.write(f'// Size: {int(round(size / 1024))}kb\n');        
+        f.write(f'//\n\n');
+        f.write(f'#pragma once\n\n');        
+        f.write(f'#include <tgx.h>\n\n'); 
+        f.write(f'// the image object\n')
+        f.write(f'extern const tgx::ImageRLE {name};\n\n')                
+        f.write(f'// end of file {name}.h\n\n')
+    
+    print(f"file [{name}.h] and [{name}.cpp] created ({len(data)} words).\n\n")
+    
+    
+
+
 # In[ ]:
 
 
@@ -218,6 +340,19 @@ height = arim.shape[1]
 nbchannels = arim.shape[2]
 print(f"\nImage size : {width}x{height} with {nbchannels} color channels\n")
 
+# Choose output color type
+while True:    
+    color_type = input("\nChoose the image color type: RGB565, RGB24, RGB32 or RGBf ? ")
+    color_type = colorName(color_type)
+    if (color_type != ""):
+        break
+
+# RLE format (RGB565 only)
+use_rle = False
+if (color_type == "RGB565"):
+    ans = input("Do you want to save the image in RLE format (y/N)?")
+    use_rle = (ans.lower() == 'y')
+
 # deal with transparency in the source image
 if nbchannels == 4:
     minalpha = minAlpha(arim)
@@ -225,19 +360,13 @@ if nbchannels == 4:
         print("- this image has an alpha channel but all pixels are fully opaque.\n")
     else:   
         print("- this image uses transparency.\n")
-        ans = input("Do you want to convert colors to pre-multiplied alpha (Y/n)?")
-        if not (ans.lower() =='n'):
-            arim = premultiply(arim)
+        if not use_rle: # RLE images blend with plain alpha
+            ans = input("Do you want to convert colors to pre-multiplied alpha (Y/n)?")
+            if not (ans.lower() =='n'):
+                arim = premultiply(arim)
 else:
     arim = addAlphaChannel(arim)
     minalpha = 255
-    
-# Choose output color type
-while True:    
-    color_type = input("\nChoose the image color type: RGB565, RGB24, RGB32 or RGBf ? ")
-    color_type = colorName(color_type)
-    if (color_type != ""):
-        break
 
 # change color value range when using 5/6/5 bits images
 if (color_type == "RGB565"):
@@ -248,7 +377,13 @@ use_tc = False
 tc = [1,1,1]# transparent color
 alt_tc = [1,0,1] # alternate color for pixel with inital color tc
 
-if (minalpha < 255):
+rle_threshold = 1
+rle_keep_alpha = False
+if (minalpha < 255) and use_rle:
+    rle_threshold = int(input("- alpha threshold (in [1,255]) below which pixels are transparent ? "))
+    ans = input("- keep partially transparent pixels as alpha runs (Y/n)?")
+    rle_keep_alpha = not (ans.lower() == 'n')
+elif (minalpha < 255):
     if (color_type == "RGB565") or (color_type == "RGB24"):
         ans = input("The output color format does not contain an alpha channel\nDo you want to specify an alpha threshold to use a transparent color?").lower()
         if (ans == 'y'):
@@ -260,7 +395,10 @@ if (minalpha < 255):
             print(f"  Found {m} transparent pixels.")
 
 filename = input("Name of the image ? ")
-createCPP(arim, color_type, filename, tc if use_tc else None)
+if use_rle:
+    createRLE(arim, filename, rle_threshold, rle_keep_alpha)
+else:
+    createCPP(arim, color_type, filename, tc if use_tc else None)
             
 
 
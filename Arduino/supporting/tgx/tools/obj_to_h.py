@@ -6,8 +6,11 @@
 
 import sys
 from collections import defaultdict
+import heapq
 import math
 import re
+import struct
+import time
 
 
 # In[ ]:
@@ -24,6 +27,18 @@ def error(msg):
 # In[ ]:
 
 
+def printStats(step, dt, nbtri = 0):
+    """
+    Print the time dt (in seconds) spent in a conversion step when the script is run with
+    the --stats option.
+    """
+    if "--stats" in sys.argv[1:]:
+        print(f"[stats] {step}: {round(dt, 3)}s" + (f" ({round(nbtri/dt)} triangles/s)" if (nbtri > 0 and dt > 0) else ""))
+
+
+# In[ ]:
+
+
 def invertEdge(E):
     return (E[1], E[0])
 
@@ -448,6 +463,146 @@ def reorderObjectTriangles(obj):
 # In[ ]:
 
 
+def optimizeObjectTriangles(obj):
+    """
+    Reorder the triangles of an object into chains (same output as reorderObjectTriangles()).
+
+    The renderer transforms the 3 vertices of the first triangle of a chain and then a single
+    vertex for each following triangle so the cost is driven by the number of chains. The
+    chains are grown greedily but, at each step, the next triangle is the neighbor (across
+    one of the two edges allowed by the DBIT) with the fewest free neighbors left so that
+    triangles do not get isolated. A new chain starts next to the end of the previous one
+    when possible (vertex locality) and otherwise at a free triangle with the fewest free
+    neighbors.
+
+    The adjacency is precomputed and the free triangles are kept in heaps with lazy deletion
+    (a global one and one for each vertex shared by many triangles) so the running time is
+    O(n log n) for n triangles (when each edge is shared by a bounded number of triangles).
+    """
+    nbt = len(obj)
+    used = [False] * nbt
+    dicedge = defaultdict(lambda: []) # mapping from edge to triangles indexes
+    for i, (A, B, C) in enumerate(obj):
+        dicedge[(A, B)].append(i)
+        dicedge[(B, C)].append(i)
+        dicedge[(C, A)].append(i)
+    # triangles sharing an edge with each triangle
+    nbr = []
+    for i, (A, B, C) in enumerate(obj):
+        S = set(dicedge.get((B, A), ()))
+        S.update(dicedge.get((C, B), ()))
+        S.update(dicedge.get((A, C), ()))
+        S.discard(i)
+        nbr.append(S)
+    valence = [len(S) for S in nbr] # number of free neighbors
+    heap = [(valence[i], i) for i in range(nbt)]
+    heapq.heapify(heap)
+    # triangles around each vertex, also kept in a heap of (valence, triangle index) when
+    # there are too many of them to be scanned each time
+    MAXSCAN = 16
+    vertri = defaultdict(lambda: [])
+    for i, T in enumerate(obj):
+        for el in T:
+            vertri[el[0]].append(i)
+    vheap = {}
+    for v, L in vertri.items():
+        if len(L) > MAXSCAN:
+            vheap[v] = [(valence[j], j) for j in L]
+            heapq.heapify(vheap[v])
+
+    def use(i):
+        used[i] = True
+        for j in nbr[i]:
+            if not used[j]:
+                valence[j] -= 1
+                heapq.heappush(heap, (valence[j], j))
+                for el in obj[j]:
+                    H = vheap.get(el[0])
+                    if H != None:
+                        heapq.heappush(H, (valence[j], j))
+
+    # remove the used and outdated entries at the top of heap H
+    def cleanHeap(H):
+        while len(H) > 0 and (used[H[0][1]] or H[0][0] != valence[H[0][1]]):
+            heapq.heappop(H)
+
+    # free triangle with the fewest free neighbors across edge E of triangle i (or None)
+    def nextTriangle(i, E):
+        best = None
+        for j in dicedge[invertEdge(E)]:
+            if j != i and not used[j] and (best == None or (valence[j], j) < (valence[best], best)):
+                best = j
+        return best
+
+    # first triangle of a new chain
+    def startTriangle(last):
+        best = None
+        if last != None: # sharing a vertex with the last triangle of the previous chain...
+            for el in last:
+                H = vheap.get(el[0])
+                if H != None:
+                    cleanHeap(H)
+                    if len(H) > 0 and (best == None or H[0] < best):
+                        best = H[0]
+                else:
+                    for j in vertri[el[0]]:
+                        if not used[j] and (best == None or (valence[j], j) < best):
+                            best = (valence[j], j)
+        if best != None:
+            return best[1]
+        cleanHeap(heap) # ... or anywhere
+        return heap[0][1] if len(heap) > 0 else None
+
+    MAXCHAINLEN = 65535
+    R = []
+    last = None
+    while True:
+        i = startTriangle(last)
+        if i == None:
+            return R
+        use(i)
+        T = obj[i]
+        # leave the first triangle through any edge and rotate it so that this edge becomes edge 2 (DBIT = 0)
+        E, j = None, None
+        for k in range(3):
+            jj = nextTriangle(i, edge(T, k))
+            if jj != None and (j == None or valence[jj] < valence[j]):
+                E, j = edge(T, k), jj
+        if E != None:
+            T = rotateTriangleStartEdge(T, edgeAfter(T, E))
+        C = [(None, T)]
+        while j != None and len(C) < MAXCHAINLEN:
+            n = 0 if E == edge(T, 2) else 1
+            use(j)
+            i = j
+            T = rotateTriangleStartEdge(obj[i], invertEdge(E))
+            C.append((n, T))
+            # then leave through edge 2 (DBIT = 0) or edge 1 (DBIT = 1)
+            E, j = None, None
+            for k in (2, 1):
+                jj = nextTriangle(i, edge(T, k))
+                if jj != None and (j == None or valence[jj] < valence[j]):
+                    E, j = edge(T, k), jj
+        last = T
+        R.append(C)
+
+
+# In[ ]:
+
+
+def chainStats(R):
+    """
+    Return a string with the statistics of the chains of an object: average chain length
+    and number of vertex transforms per triangle done by the renderer.
+    """
+    nbc = len(R)
+    nbt = sum([len(C) for C in R])
+    return f"{nbc} chains, average length {round(nbt/nbc, 2)}, {round((nbt + 2*nbc)/nbt, 3)} vertex transforms per triangle"
+
+
+# In[ ]:
+
+
 def reorderVNTarrays(vertice, texture, normal, R):
     
     def orderByFirstUse(ar, R, index):
@@ -568,7 +723,95 @@ def arraytoString(array):
 # In[ ]:
 
 
-def savemodel(vertice, texture, normal, R, modelname, texturenames, tag, color, lightning, BB, BBS):    
+def flatArraytoString(array):
+    return "{\n" + ("\n".join( [ ",".join([str(i) for i in u]) + "," for u in array] )).rstrip(",") + "\n};\n"
+
+
+# In[ ]:
+
+
+def quantizeVertice(vertice):
+    """
+    Quantize the vertices to int16 inside their bounding box (compact format).
+    Return the quantized array and the (exact) box used.
+    """
+    box = findBoundingBox(vertice)
+    res = []
+    for V in vertice:
+        q = []
+        for i in range(3):
+            a, b = box[2*i], box[2*i+1]
+            t = 0 if b <= a else (V[i] - a)/(b - a)
+            q.append(min(65535, max(0, round(t*65535))) - 32768)
+        res.append(tuple(q))
+    return res, box
+
+
+def quantizeTexture(texture):
+    """
+    Quantize the texture coords to uint16 inside their bounding box (compact format).
+    Return the quantized array and the box used.
+    """
+    umin = min(T[0] for T in texture)
+    umax = max(T[0] for T in texture)
+    vmin = min(T[1] for T in texture)
+    vmax = max(T[1] for T in texture)
+    box = (umin, umax, vmin, vmax)
+    res = []
+    for T in texture:
+        q = []
+        for i in range(2):
+            a, b = box[2*i], box[2*i+1]
+            t = 0 if b <= a else (T[i] - a)/(b - a)
+            q.append(min(65535, max(0, round(t*65535))))
+        res.append(tuple(q))
+    return res, box
+
+
+def decodeNormalOct16(a, b):
+    x = a/127
+    y = b/127
+    z = 1 - abs(x) - abs(y)
+    if z < 0:
+        x, y = (1 - abs(y))*(1 if x >= 0 else -1), (1 - abs(x))*(1 if y >= 0 else -1)
+    n = math.sqrt(x*x + y*y + z*z)
+    return (x/n, y/n, z/n)
+
+
+def quantizeNormal(normal):
+    """
+    Encode the (unit) normals with 16 bit octahedral encoding (compact format):
+    high byte / low byte = int8 coordinates of the normal projected on the octahedron and
+    folded onto the plane z = 0 (same decoding as tgx::decodeNormalOct16()).
+    Return the encoded array and the maximum angular error (in degrees).
+    """
+    res = []
+    maxerr = 0
+    for N in normal:
+        s = abs(N[0]) + abs(N[1]) + abs(N[2])
+        x, y, z = N[0]/s, N[1]/s, N[2]/s
+        if z < 0:
+            x, y = (1 - abs(y))*(1 if x >= 0 else -1), (1 - abs(x))*(1 if y >= 0 else -1)
+        # keep the best of the 4 nearest grid points
+        best = None
+        for a in (math.floor(x*127), math.ceil(x*127)):
+            for b in (math.floor(y*127), math.ceil(y*127)):
+                a = min(127, max(-127, a))
+                b = min(127, max(-127, b))
+                D = decodeNormalOct16(a, b)
+                d = D[0]*N[0] + D[1]*N[1] + D[2]*N[2]
+                if (best == None) or (d > best[0]):
+                    best = (d, a, b)
+        d, a, b = best
+        maxerr = max(maxerr, math.degrees(math.acos(min(1, max(-1, d)))))
+        res.append((((a & 255) << 8) | (b & 255),))
+    return res, maxerr
+
+
+# In[ ]:
+
+
+def savemodel(vertice, texture, normal, R, modelname, texturenames, tag, color, lightning, BB, BBS, compact = False):    
     
     NAMESPACE = "tgx" 
     
@@ -589,7 +832,10 @@ def savemodel(vertice, texture, normal, R, modelname, texturenames, tag, color,
             tot += len(C)
         return tot
     
-    totKB = len(vertice)*12 + len(normal)*12 + len(texture)*8 + len(R)*68
+    if compact:
+        totKB = len(vertice)*6 + len(normal)*2 + len(texture)*4 + len(R)*120
+    else:
+        totKB = len(vertice)*12 + len(normal)*12 + len(texture)*8 + len(R)*120
     for O in R:            
         for C in O: 
             elem = 1
@@ -635,20 +881,47 @@ def savemodel(vertice, texture, normal, R, modelname, texturenames, tag, color,
         name_vertice = modelname + "_vert_array"
         name_texture = modelname + "_tex_array" if len(texture) > 0 else "nullptr"
         name_normal = modelname + "_norm_array" if len(normal) > 0 else "nullptr"
- 
-        f.write(f"\n\n// vertex array: {(len(vertice)*12)//1024}kb.\n")
-        f.write(f"const {NAMESPACE}::fVec3 {name_vertice}[{len(vertice)}] PROGMEM = ")
-        f.write(arraytoString(vertice))
-    
-        if len(texture) > 0:
-            f.write(f"\n\n// texture array: {(len(texture)*8)//1024}kb.\n")
-            f.write(f"const {NAMESPACE}::fVec2 {name_texture}[{len(texture)}] PROGMEM = ")
-            f.write(arraytoString(texture))
-            
-        if len(normal) > 0:
-            f.write(f"\n\n// normal array: {(len(normal)*12)//1024}kb.\n")
-            f.write(f"const {NAMESPACE}::fVec3 {name_normal}[{len(normal)}] PROGMEM = ")
-            f.write(arraytoString(normal))
+        name_vertice_q = name_texture_q = name_normal_q = "nullptr"
+        QB = (0.0, 0.0, 0.0, 0.0, 0.0, 0.0)
+        QT = (0.0, 0.0, 0.0, 0.0)
+
+        if compact:
+            # compact format: quantized arrays, the float arrays are not emitted.
+            name_vertice_q, name_vertice = name_vertice, "nullptr"
+            qvert, QB = quantizeVertice(vertice)
+            f.write(f"\n\n// quantized vertex array: {(len(vertice)*6)//1024}kb.\n")
+            f.write(f"const int16_t {name_vertice_q}[{3*len(vertice)}] PROGMEM = ")
+            f.write(flatArraytoString(qvert))
+
+            if len(texture) > 0:
+                name_texture_q, name_texture = name_texture, "nullptr"
+                qtex, QT = quantizeTexture(texture)
+                f.write(f"\n\n// quantized texture array: {(len(texture)*4)//1024}kb.\n")
+                f.write(f"const uint16_t {name_texture_q}[{2*len(texture)}] PROGMEM = ")
+                f.write(flatArraytoString(qtex))
+
+            if len(normal) > 0:
+                name_normal_q, name_normal = name_normal, "nullptr"
+                qnorm, maxerr = quantizeNormal(normal)
+                print(f"\n- octahedral normals: max angular error {round(maxerr,3)} degrees.")
+                f.write(f"\n\n// octahedral normal array: {(len(normal)*2)//1024}kb.\n")
+                f.write(f"const uint16_t {name_normal_q}[{len(normal)}] PROGMEM = ")
+                f.write(flatArraytoString(qnorm))
+
+        else:
+            f.write(f"\n\n// vertex array: {(len(vertice)*12)//1024}kb.\n")
+            f.write(f"const {NAMESPACE}::fVec3 {name_vertice}[{len(vertice)}] PROGMEM = ")
+            f.write(arraytoString(vertice))
+        
+            if len(texture) > 0:
+                f.write(f"\n\n// texture array: {(len(texture)*8)//1024}kb.\n")
+                f.write(f"const {NAMESPACE}::fVec2 {name_texture}[{len(texture)}] PROGMEM = ")
+                f.write(arraytoString(texture))
+                
+            if len(normal) > 0:
+                f.write(f"\n\n// normal array: {(len(normal)*12)//1024}kb.\n")
+                f.write(f"const {NAMESPACE}::fVec3 {name_normal}[{len(normal)}] PROGMEM = ")
+                f.write(arraytoString(normal))
             
         f.write("\n");
             
@@ -764,7 +1037,22 @@ const {NAMESPACE}::Mesh3D<{NAMESPACE}::RGB565> {name} PROGMEM =
     {BBS[mnb][4]}f, {BBS[mnb][5]}f
     }},
     
-    "{modelname}" // model name    
+    "{modelname}", // model name    
+
+    {name_vertice_q}, // quantized array of vertices (compact format)
+    {name_texture_q}, // quantized array of texture coords (compact format)
+    {name_normal_q}, // octahedral array of normal vectors (compact format)
+
+    {{ // range of the quantized vertices
+    {QB[0]}f, {QB[1]}f, 
+    {QB[2]}f, {QB[3]}f, 
+    {QB[4]}f, {QB[5]}f
+    }},
+
+    {{ // range of the quantized texture coords
+    {QT[0]}f, {QT[1]}f, 
+    {QT[2]}f, {QT[3]}f
+    }}
     }};
     
 """)                                   
@@ -779,6 +1067,135 @@ const {NAMESPACE}::Mesh3D<{NAMESPACE}::RGB565> {name} PROGMEM =
 # In[ ]:
 
 
+def faceArray(O, elem):
+    """
+    Return the face array of an object (list of uint16) in the same format as the .h file.
+    """
+    res = []
+    def addelem(el):
+        res.append(el[0])
+        if el[1] >= 0:
+            res.append(el[1])
+        if el[2] >= 0:
+            res.append(el[2])
+    for C in O:
+        res.append(len(C))
+        addelem(C[0][1][0])
+        addelem(C[0][1][1])
+        addelem(C[0][1][2])
+        for L in C[1:]:
+            addelem( (L[1][2][0] + (32768*L[0]) , L[1][2][1] , L[1][2][2]) )
+    res.append(0)
+    if len(res) != 1 + sum([1 + (2 + len(C))*elem for C in O]):
+        error("faceArray() wrong count !")
+    return res
+
+
+def loadTextureImage(filename):
+    """
+    Load an image file and return it as (width, height, list of RGB565 pixels) ordered
+    as in the textures created by texture_2_h.py. Return None if the file cannot be read.
+    """
+    try:
+        from PIL import Image
+        import numpy as np
+        im = Image.open(filename).convert("RGB")
+    except:
+        print(f"\n*** cannot open image file [{filename}]... ***\n")
+        return None
+    if (im.width & (im.width - 1)) or (im.height & (im.height - 1)):
+        print(f"\n*** texture [{filename}] is {im.width}x{im.height}: its dimensions must be powers of two... ***\n")
+        return None
+    ar = np.asarray(im)
+    pix = []
+    for y in range(im.height):
+        for x in range(im.width):
+            rgb = ar[im.height - 1 - y, x]
+            R = int((rgb[0] + 4)*31.0/255.0) << 11
+            G = int((rgb[1] + 2)*63.0/255.0) << 5
+            B = int((rgb[2] + 4)*31.0/255.0)
+            pix.append(R + G + B)
+    print(f"- texture [{filename}] of size {im.width}x{im.height}.")
+    return (im.width, im.height, pix)
+
+
+def savemodelbinary(vertice, texture, normal, R, modelname, textureimages, color, lightning, BBS, compact = False):
+    """
+    Save the model in the binary format described in tgx/MeshFile.h (file modelname.tgxm)
+    which can be loaded at runtime with tgx::loadMeshBinary().
+    """
+    HEADER_SIZE = 72
+    RECORD_SIZE = 96
+
+    if (len(vertice) > 32767) or (len(texture) > 65535) or (len(normal) > 65535):
+        error("Model too large !")
+
+    elem = 1
+    if len(texture) > 0:
+        elem +=1
+    if len(normal) > 0:
+        elem +=1
+
+    data = bytearray(HEADER_SIZE + RECORD_SIZE*len(R))
+
+    def append(b):
+        # every array starts on a 4 bytes boundary
+        nonlocal data
+        data += bytes((-len(data)) % 4)
+        offset = len(data)
+        data += b
+        return offset
+
+    def flat(ar):
+        return [x for u in ar for x in u]
+
+    QB = (0.0, 0.0, 0.0, 0.0, 0.0, 0.0)
+    QT = (0.0, 0.0, 0.0, 0.0)
+    toff = noff = 0
+    if compact:
+        qvert, QB = quantizeVertice(vertice)
+        voff = append(struct.pack(f"<{3*len(vertice)}h", *flat(qvert)))
+        if len(texture) > 0:
+            qtex, QT = quantizeTexture(texture)
+            toff = append(struct.pack(f"<{2*len(texture)}H", *flat(qtex)))
+        if len(normal) > 0:
+            qnorm, maxerr = quantizeNormal(normal)
+            print(f"\n- octahedral normals: max angular error {round(maxerr,3)} degrees.")
+            noff = append(struct.pack(f"<{len(normal)}H", *flat(qnorm)))
+    else:
+        voff = append(struct.pack(f"<{3*len(vertice)}f", *flat(vertice)))
+        if len(texture) > 0:
+            toff = append(struct.pack(f"<{2*len(texture)}f", *flat(texture)))
+        if len(normal) > 0:
+            noff = append(struct.pack(f"<{3*len(normal)}f", *flat(normal)))
+
+    for mnb, O in enumerate(R):
+        name = modelname if len(R) == 1 else modelname + "_" + str(mnb + 1)
+        faces = faceArray(O, elem)
+        foff = append(struct.pack(f"<{len(faces)}H", *faces))
+        texoff, tlx, tly = 0, 0, 0
+        if textureimages[mnb] != None:
+            tlx, tly, pix = textureimages[mnb]
+            texoff = append(struct.pack(f"<{len(pix)}H", *pix))
+        struct.pack_into("<HHIIHH3ffffi6f28s", data, HEADER_SIZE + RECORD_SIZE*mnb,
+                         sum([len(C) for C in O]), len(faces), foff, texoff, tlx, tly,
+                         *color[mnb], *lightning[mnb][:3], int(lightning[mnb][3]),
+                         *BBS[mnb], name.encode()[:27])
+    data += bytes((-len(data)) % 4)
+
+    struct.pack_into("<4sHHIHHHHIII6f4f", data, 0,
+                     b"TGXM", 1, len(R), len(data),
+                     len(vertice), len(texture), len(normal), 1 if compact else 0,
+                     voff, toff, noff, *QB, *QT)
+
+    with open(modelname + ".tgxm", "wb") as f:
+        f.write(data)
+    print(f"\n- binary file size: {len(data)} bytes.")
+
+
+# In[ ]:
+
+
 def getColorLightning(use_default_cl, nb):
     
     DEFAULT_COLOR = (0.75,0.75,0.75) # silver
@@ -800,7 +1217,7 @@ def getColorLightning(use_default_cl, nb):
     lighttxt = input(f"- lightning for object {nb}. [ENTER] for default: {DEFAULT_LIGHTNING}")
     try:
         light = [ float(l) for l in re.split(',|\(|\)| ', lighttxt) if len(l)>0] 
-        light[3] = int(light[3])
+        light[3] = min(max(int(light[3]), 0), 100) # same range as setMaterialSpecularExponent()
     except:
         light = []    
     if (len(light) != 4):
@@ -826,7 +1243,9 @@ if not filename.lower().endswith(".obj"):
 print()
 
 #load the file
+t0 = time.perf_counter()
 vertice, texture, normal, obj, tag = loadObjFile(filename)
+printStats("loading", time.perf_counter() - t0, sum([len(x) for x in obj]))
     
 # create normals if needed and normalize them.
 normal = fixNormals(vertice, normal, obj)
@@ -841,14 +1260,23 @@ print("")
 R = []
 for i,x in enumerate(obj):
     print(f"Reordering object {i+1} with {len(x)} triangles... ", end="")
+    t0 = time.perf_counter()
     U = reorderObjectTriangles(x)
-    print(f"Done. {len(U)} chains created.")            
-    R.append(U)
+    t1 = time.perf_counter()
+    V = optimizeObjectTriangles(x)
+    print(f"Done.")
+    print(f"  - before: {chainStats(U)}")
+    print(f"  - after : {chainStats(V)}")
+    printStats("chaining", t1 - t0, len(x))
+    printStats("optimizing", time.perf_counter() - t1, len(x))
+    R.append(V if len(V) <= len(U) else U)
 
 # renumber vertices/texture/normal optimize cache acess
 print("\nrenumbering vertices/texture/normals...", end="")
+t0 = time.perf_counter()
 reorderVNTarrays(vertice, texture, normal, R)
 print("Done.\n")
+printStats("renumbering", time.perf_counter() - t0)
 
 # recenter and rescale the model if needed
 vertice, BB = recenterAndRescale(vertice)
@@ -863,23 +1291,41 @@ modelname = input("\n\nname of this model ? ")
 ans = input("\nuse default color/lightning parameters (Y/n) ?")
 use_default_cl = True if len(ans) == 0 or (ans.lower())[0] == "y" else False
 
-# get the texture names
+ans = input("\nuse the compact format: quantized vertices/normals/texture coords, about 3x smaller (y/N) ?")
+compact = True if len(ans) > 0 and (ans.lower())[0] == "y" else False
+
+ans = input("\nsave as a binary .tgxm file (to load from an SD card) instead of a .h file (y/N) ?")
+binary = True if len(ans) > 0 and (ans.lower())[0] == "y" else False
+
+# get the texture names (or the texture images for a binary file)
 color = [None] * len(obj)
 lightning = [None] * len(obj)
 texturenames = [None] * len(obj)
+textureimages = [None] * len(obj)
 for i in range(len(obj)):
     if (len(texture)>0):    
-        tname = input(f"\n\n- name of texture for object {i+1} [{tag[i]}] (press [ENTER] if none) ? ")        
-        if (len(tname) > 0):
-            texturenames[i] = tname            
+        if binary:
+            tname = input(f"\n\n- image file of the texture for object {i+1} [{tag[i]}] (press [ENTER] if none) ? ")
+            if (len(tname) > 0):
+                textureimages[i] = loadTextureImage(tname)
+        else:
+            tname = input(f"\n\n- name of texture for object {i+1} [{tag[i]}] (press [ENTER] if none) ? ")        
+            if (len(tname) > 0):
+                texturenames[i] = tname            
     color[i] , lightning[i] = getColorLightning(use_default_cl, i+1)
-        
-savemodel(vertice, texture, normal, R,
-          modelname, texturenames, tag, color, lightning, BB, BBS)
+
+t0 = time.perf_counter()
+if binary:
+    savemodelbinary(vertice, texture, normal, R,
+                    modelname, textureimages, color, lightning, BBS, compact)
+else:
+    savemodel(vertice, texture, normal, R,
+              modelname, texturenames, tag, color, lightning, BB, BBS, compact)
+printStats("saving", time.perf_counter() - t0)
 
 
 
-print(f"\n*** conversion complete: model saved in [{modelname + '.h'}] ***\n\n")
+print(f"\n*** conversion complete: model saved in [{modelname + ('.tgxm' if binary else '.h')}] ***\n\n")
 
 
 # In[ ]: